@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <sstream>
+#include <string>
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
+#include <vector>
+
+#include "seamcarving.h"
+#include "simd.h"
+
+#define BENCH_SEAMS 50      // Seams retirés par les mesures de boucle
+#define BENCH_REPETITIONS 3 // Répétitions des mesures, on garde la meilleure
+
+using namespace cv;
+using namespace std;
+
+/**
+ * Image couleur synthétique, identique d'une exécution à l'autre : dégradés
+ * lents, rectangles francs et bruit, pour que l'énergie ne soit ni uniforme
+ * ni aléatoire.
+ *
+ * @param rows Nombre de lignes
+ * @param cols Nombre de colonnes
+ * @return Image BGR
+ */
+static Mat imageSynthetique(int rows, int cols) {
+  Mat image(rows, cols, CV_8UC3);
+  for (int i = 0; i < rows; ++i) {
+    unsigned char *ligne = image.ptr<unsigned char>(i);
+    for (int j = 0; j < cols; ++j) {
+      unsigned int bruit = (unsigned int)(i * 73856093u) ^
+                           (unsigned int)(j * 19349663u);
+      bruit = (bruit ^ (bruit >> 13)) * 0x5bd1e995u;
+      bool rectangle = ((i / 97) + (j / 131)) % 5 == 0;
+      ligne[3 * j] = (unsigned char)(j * 255 / cols + (bruit & 15));
+      ligne[3 * j + 1] = (unsigned char)(i * 255 / rows + (bruit >> 28));
+      ligne[3 * j + 2] = rectangle ? 230 : (unsigned char)(bruit >> 24) / 4;
+    }
+  }
+  return image;
+} // Fin imageSynthetique
+
+/**
+ * Mesure la meilleure durée d'une opération.
+ *
+ * @param operation Opération mesurée
+ * @param preparer Préparation avant chaque répétition, non mesurée
+ * @param repetitions Nombre de répétitions
+ * @return Durée minimale, en millisecondes
+ */
+static double mesurer(const function<void()> &operation,
+                      const function<void()> &preparer, int repetitions) {
+  double meilleure = 0;
+  for (int r = 0; r < repetitions; ++r) {
+    if (preparer) {
+      preparer();
+    }
+    auto debut = chrono::steady_clock::now();
+    operation();
+    double duree = chrono::duration<double, milli>(
+                       chrono::steady_clock::now() - debut)
+                       .count();
+    if (r == 0 || duree < meilleure) {
+      meilleure = duree;
+    }
+  }
+  return meilleure;
+} // Fin mesurer
+
+/**
+ * Lit une liste d'entiers séparés par des virgules.
+ *
+ * @param texte Liste (ex : 1,2,4)
+ * @return Entiers lus
+ */
+static vector<int> lireListe(const string &texte) {
+  vector<int> valeurs;
+  stringstream flux(texte);
+  string element;
+  while (getline(flux, element, ',')) {
+    valeurs.push_back(atoi(element.c_str()));
+  }
+  return valeurs;
+} // Fin lireListe
+
+/**
+ * Lit une liste de tailles (ex : 640x480,1920x1080).
+ *
+ * @param texte Liste de tailles
+ * @return Tailles lues (largeur, hauteur)
+ */
+static vector<Size> lireTailles(const string &texte) {
+  vector<Size> tailles;
+  stringstream flux(texte);
+  string element;
+  while (getline(flux, element, ',')) {
+    int largeur = 0, hauteur = 0;
+    if (sscanf(element.c_str(), "%dx%d", &largeur, &hauteur) == 2) {
+      tailles.push_back(Size(largeur, hauteur));
+    }
+  }
+  return tailles;
+} // Fin lireTailles
+
+/**
+ * Banc d'essai des étapes du seam carving.
+ *
+ * Chaque étape est mesurée sur des images synthétiques de plusieurs tailles
+ * et pour plusieurs nombres de threads. Une ligne CSV est écrite sur la
+ * sortie standard par mesure : débit en mégapixels par seconde, durée par
+ * seam et accélération par rapport au premier nombre de threads.
+ */
+int main(int argc, char *argv[]) {
+  vector<Size> tailles = {Size(640, 480), Size(1920, 1080), Size(3840, 2160),
+                          Size(12000, 9000)};
+  vector<int> threads;
+  for (int t = 1; t < tbb::this_task_arena::max_concurrency(); t *= 2) {
+    threads.push_back(t);
+  }
+  threads.push_back(tbb::this_task_arena::max_concurrency());
+  int nb_seams = BENCH_SEAMS;
+  int repetitions = BENCH_REPETITIONS;
+
+  for (int i = 1; i < argc; ++i) {
+    string option = argv[i];
+    if (option == "--tailles" && i + 1 < argc) {
+      tailles = lireTailles(argv[++i]);
+    } else if (option == "--threads" && i + 1 < argc) {
+      threads = lireListe(argv[++i]);
+    } else if (option == "--seams" && i + 1 < argc) {
+      nb_seams = atoi(argv[++i]);
+    } else if (option == "--repetitions" && i + 1 < argc) {
+      repetitions = atoi(argv[++i]);
+    } else {
+      cerr << "Usage : " << argv[0]
+           << " [--tailles LxH,...] [--threads N,...] [--seams N]"
+              " [--repetitions N]"
+           << endl;
+      return EXIT_FAILURE;
+    }
+  }
+  if (tailles.empty() || threads.empty() || nb_seams < 1 ||
+      repetitions < 1 ||
+      any_of(threads.begin(), threads.end(), [](int t) { return t < 1; })) {
+    cerr << "Paramètres du banc d'essai invalides." << endl;
+    return EXIT_FAILURE;
+  }
+
+  // seamCarving enregistre ses images : on les écrit dans un répertoire
+  // temporaire, au format BMP pour ne pas mesurer la compression
+  string repertoire =
+      (filesystem::temp_directory_path() / "seam_bench").string() + "/";
+  filesystem::create_directories(repertoire);
+
+  cout << "etape,largeur,hauteur,threads,simd,ms,mpix_s,ns_seam,acceleration"
+       << endl;
+
+  for (const Size &taille : tailles) {
+    int rows = taille.height, cols = taille.width;
+    // Les suppressions retirent nb_seams fois la colonne cols / 2, qui doit
+    // rester dans l'image
+    if (nb_seams >= cols / 2 || nb_seams >= rows) {
+      cerr << "Image " << cols << "x" << rows << " trop petite, ignorée."
+           << endl;
+      continue;
+    }
+    Mat image = imageSynthetique(rows, cols);
+    Mat gris;
+    cvtColor(image, gris, COLOR_BGR2GRAY);
+    double mpix = (double)rows * cols / 1e6;
+
+    // Durée de référence de chaque étape, au premier nombre de threads
+    vector<double> reference;
+
+    for (size_t n = 0; n < threads.size(); ++n) {
+      cerr << "Image " << cols << "x" << rows << ", " << threads[n]
+           << " thread(s)" << endl;
+      tbb::global_control limite(
+          tbb::global_control::max_allowed_parallelism, threads[n]);
+      tbb::task_arena arena(threads[n]);
+
+      size_t etape = 0;
+      auto ecrire = [&](const string &nom, double ms, double nb_mpix,
+                        int seams) {
+        if (n == 0) {
+          reference.push_back(ms);
+        }
+        cout << nom << "," << cols << "," << rows << "," << threads[n] << ","
+             << simdNiveau() << "," << ms << "," << nb_mpix / (ms / 1e3)
+             << "," << ms * 1e6 / seams << "," << reference[etape] / ms
+             << endl;
+        ++etape;
+      };
+
+      arena.execute([&] {
+        Mat flou, energie;
+        ecrire("filtreGaussien",
+               mesurer([&] { flou = filtreGaussien(gris); }, nullptr,
+                       repetitions),
+               mpix, 1);
+        ecrire("filtreGradient",
+               mesurer([&] { energie = filtreGradient(flou); }, nullptr,
+                       repetitions),
+               mpix, 1);
+        ecrire("filtreEnergie",
+               mesurer([&] { energie = filtreEnergie(gris); }, nullptr,
+                       repetitions),
+               mpix, 1);
+
+        SeamWorkspace ws;
+        if (!allouerWorkspace(ws, rows, cols)) {
+          exit(EXIT_FAILURE);
+        }
+        ecrire("matriceCumulativeCols",
+               mesurer([&] { matriceCumulativeCols(energie, ws.m_cumul); },
+                       nullptr, repetitions),
+               mpix, 1);
+        ecrire("findWayCols",
+               mesurer([&] { findWayCols(energie, ws.m_cumul, ws.way); },
+                       nullptr, repetitions),
+               mpix, 1);
+        ecrire("matriceCumulativeRows",
+               mesurer([&] { matriceCumulativeRows(energie, ws.m_cumul); },
+                       nullptr, repetitions),
+               mpix, 1);
+        ecrire("findWayRows",
+               mesurer([&] { findWayRows(energie, ws.m_cumul, ws.way); },
+                       nullptr, repetitions),
+               mpix, 1);
+
+        // Matrice compacte : bande glissante et directions sur 2 bits
+        SeamWorkspace ws_compact;
+        if (!allouerWorkspace(ws_compact, rows, cols, 1, true)) {
+          exit(EXIT_FAILURE);
+        }
+        ecrire("matriceCumulativeColsCompacte",
+               mesurer(
+                   [&] {
+                     matriceCumulativeColsCompacte(energie, ws_compact.m_cumul,
+                                                   ws_compact.directions);
+                   },
+                   nullptr, repetitions),
+               mpix, 1);
+        ecrire("findWayColsCompacte",
+               mesurer(
+                   [&] {
+                     findWayColsCompacte(energie, ws_compact.m_cumul,
+                                         ws_compact.directions, ws_compact.way);
+                   },
+                   nullptr, repetitions),
+               mpix, 1);
+        libererWorkspace(ws_compact);
+
+        // Suppressions d'un seam droit, au milieu de l'image
+        vector<int> milieu(rows, cols / 2);
+        Mat copie;
+        ecrire("suppressionSeamGray",
+               mesurer(
+                   [&] {
+                     for (int s = 0; s < nb_seams; ++s) {
+                       suppressionSeamGray(copie, milieu.data(), SEAM_COLS);
+                     }
+                   },
+                   [&] { copie = energie.clone(); }, repetitions),
+               mpix * nb_seams, nb_seams);
+        ecrire("suppressionSeamColor",
+               mesurer(
+                   [&] {
+                     for (int s = 0; s < nb_seams; ++s) {
+                       suppressionSeamColor(copie, milieu.data(), SEAM_COLS);
+                     }
+                   },
+                   [&] { copie = image.clone(); }, repetitions),
+               mpix * nb_seams, nb_seams);
+
+        // Boucle de carving exacte, énergie déjà calculée
+        Mat copie_energie;
+        vector<int> seams((size_t)nb_seams * rows);
+        ecrire("boucleSeamsCols",
+               mesurer(
+                   [&] {
+                     boucleSeamsColsSequence(copie, copie_energie, nb_seams,
+                                             ws, seams.data(), false, 0);
+                   },
+                   [&] {
+                     copie = image.clone();
+                     copie_energie = energie.clone();
+                   },
+                   1),
+               mpix * nb_seams, nb_seams);
+        libererWorkspace(ws);
+
+        // Carving complet, énergie et enregistrement compris ; ses messages
+        // ne doivent pas se mêler au CSV
+        streambuf *sortie = cout.rdbuf();
+        ostringstream muet;
+        double ms = mesurer(
+            [&] {
+              cout.rdbuf(muet.rdbuf());
+              seamCarving(image.clone(), gris.clone(), nb_seams, "bench.bmp",
+                          repertoire, SEAM_COLS);
+              cout.rdbuf(sortie);
+            },
+            nullptr, 1);
+        ecrire("seamCarving", ms, mpix * nb_seams, nb_seams);
+      });
+    }
+  }
+
+  filesystem::remove_all(repertoire);
+  return EXIT_SUCCESS;
+} // Fin main
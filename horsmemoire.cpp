@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <vector>
+
+#include "horsmemoire.h"
+#include "profil.h"
+#include "seamcarving.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * Zone d'un fichier temporaire projetée en mémoire. Le fichier est supprimé
+ * dès sa création : il disparaît avec la projection.
+ */
+struct ZoneProjetee {
+  uchar *adresse = nullptr;
+  size_t taille = 0;
+
+  ZoneProjetee() = default;
+  ZoneProjetee(const ZoneProjetee &) = delete;
+  ZoneProjetee &operator=(const ZoneProjetee &) = delete;
+  ~ZoneProjetee() {
+    if (adresse) {
+      munmap(adresse, taille);
+    }
+  }
+};
+
+/**
+ * Image source, lue par bandes de lignes : en flux pour les PPM et PGM
+ * binaires sur 8 bits, sinon décodée en entier par imread.
+ */
+struct SourceImage {
+  FILE *fichier = nullptr;
+  int canaux = 3;
+  Mat image;
+  int largeur = 0;
+  int hauteur = 0;
+};
+
+/**
+ * Projette en mémoire un nouveau fichier temporaire. La place est réservée
+ * sur le disque dès maintenant : un disque plein est signalé ici plutôt
+ * qu'à la première écriture dans la zone.
+ *
+ * @param zone Zone à projeter
+ * @param taille Taille en octets
+ * @return true si la projection a réussi
+ */
+static bool projeterZone(ZoneProjetee &zone, size_t taille) {
+  taille = max(taille, (size_t)1);
+  string modele =
+      (filesystem::temp_directory_path() / "seamcarving_XXXXXX").string();
+  vector<char> nom(modele.begin(), modele.end());
+  nom.push_back('\0');
+
+  int fd = mkstemp(nom.data());
+  if (fd < 0) {
+    perror("Erreur de création du fichier tampon");
+    return false;
+  }
+  unlink(nom.data());
+
+  int erreur = posix_fallocate(fd, 0, (off_t)taille);
+  if (erreur != 0) {
+    cerr << "Erreur de réservation du fichier tampon : " << strerror(erreur)
+         << endl;
+    close(fd);
+    return false;
+  }
+  void *adresse =
+      mmap(nullptr, taille, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (adresse == MAP_FAILED) {
+    perror("Erreur de projection du fichier tampon");
+    return false;
+  }
+
+  zone.adresse = (uchar *)adresse;
+  zone.taille = taille;
+  return true;
+} // Fin projeterZone
+
+/**
+ * Rend au système les pages de la zone présentes en mémoire. Leur contenu
+ * reste dans le fichier et sera relu au prochain accès.
+ *
+ * @param zone Zone projetée (peut ne pas l'être)
+ */
+static void relacherZone(const ZoneProjetee &zone) {
+  if (zone.adresse) {
+    madvise(zone.adresse, zone.taille, MADV_DONTNEED);
+  }
+} // Fin relacherZone
+
+/**
+ * Lit un entier de l'en-tête d'une image PPM ou PGM, commentaires compris,
+ * ainsi que le blanc qui le suit.
+ *
+ * @param fichier Fichier ouvert
+ * @param valeur Reçoit l'entier
+ * @return true si un entier suivi d'un blanc a été lu
+ */
+static bool lireEntierPnm(FILE *fichier, int &valeur) {
+  int c = fgetc(fichier);
+  while (c == '#' || isspace(c)) {
+    if (c == '#') {
+      while (c != '\n' && c != EOF) {
+        c = fgetc(fichier);
+      }
+    }
+    c = fgetc(fichier);
+  }
+  if (!isdigit(c)) {
+    return false;
+  }
+
+  valeur = 0;
+  while (isdigit(c)) {
+    if (valeur > (INT_MAX - 9) / 10) {
+      return false;
+    }
+    valeur = valeur * 10 + (c - '0');
+    c = fgetc(fichier);
+  }
+  return isspace(c);
+} // Fin lireEntierPnm
+
+/**
+ * Ouvre l'image source : les PPM (P6) et PGM (P5) binaires sur 8 bits sont
+ * gardés ouverts pour être lus en flux, les autres images sont décodées par
+ * imread.
+ *
+ * @param source Chemin de l'image
+ * @param src Reçoit l'image ouverte
+ * @return true si l'image a pu être ouverte
+ */
+static bool ouvrirSource(const string &source, SourceImage &src) {
+  FILE *fichier = fopen(source.c_str(), "rb");
+  if (fichier) {
+    int maxval = 0;
+    char magique[2];
+    if (fread(magique, 1, 2, fichier) == 2 && magique[0] == 'P' &&
+        (magique[1] == '5' || magique[1] == '6') &&
+        lireEntierPnm(fichier, src.largeur) &&
+        lireEntierPnm(fichier, src.hauteur) && lireEntierPnm(fichier, maxval) &&
+        maxval == 255 && src.largeur > 0 && src.hauteur > 0) {
+      src.fichier = fichier;
+      src.canaux = (magique[1] == '6') ? 3 : 1;
+      return true;
+    }
+    fclose(fichier);
+  }
+
+  src.image = imread(source, IMREAD_COLOR);
+  if (src.image.empty()) {
+    cerr << "Erreur de lecture de l'image (horsmemoire)!" << endl;
+    return false;
+  }
+  src.largeur = src.image.cols;
+  src.hauteur = src.image.rows;
+  return true;
+} // Fin ouvrirSource
+
+/**
+ * Lit les lignes [y, y + nb_lignes) de l'image source, dans l'ordre.
+ *
+ * @param src Image source
+ * @param y Première ligne
+ * @param nb_lignes Nombre de lignes
+ * @param bande Reçoit les lignes, en BGR
+ * @return true si la lecture a réussi
+ */
+static bool lireBande(SourceImage &src, int y, int nb_lignes, Mat &bande) {
+  if (!src.fichier) {
+    bande = src.image.rowRange(y, y + nb_lignes);
+    return true;
+  }
+
+  Mat brute(nb_lignes, src.largeur, src.canaux == 3 ? CV_8UC3 : CV_8UC1);
+  size_t taille = (size_t)nb_lignes * src.largeur * src.canaux;
+  if (fread(brute.data, 1, taille, src.fichier) != taille) {
+    cerr << "Erreur : image tronquée." << endl;
+    return false;
+  }
+
+  if (src.canaux == 1) {
+    cvtColor(brute, bande, COLOR_GRAY2BGR);
+    return true;
+  }
+  // Le fichier est en RGB
+  uchar *pixel = brute.data;
+  for (size_t p = 0; p < taille; p += 3) {
+    swap(pixel[p], pixel[p + 2]);
+  }
+  bande = brute;
+  return true;
+} // Fin lireBande
+
+/**
+ * Copie la transposée de source dans les colonnes [colonne, colonne +
+ * source.rows) de dest, par tuiles de BANDE_HORS_MEMOIRE de côté. La zone
+ * est relâchée après chaque tuile : une colonne de l'image touche une page
+ * par ligne, une tuile n'en touche qu'une bande.
+ *
+ * @param source Image à transposer
+ * @param dest Image de destination, de source.cols lignes
+ * @param colonne Première colonne de destination
+ * @param zone Zone projetée de source ou de dest
+ */
+static void copierTransposee(const Mat &source, Mat &dest, int colonne,
+                             const ZoneProjetee &zone) {
+  size_t taille_pixel = dest.elemSize();
+  for (int i = 0; i < source.rows; i += BANDE_HORS_MEMOIRE) {
+    for (int j = 0; j < source.cols; j += BANDE_HORS_MEMOIRE) {
+      Mat tuile;
+      transpose(source(Rect(j, i, min(BANDE_HORS_MEMOIRE, source.cols - j),
+                            min(BANDE_HORS_MEMOIRE, source.rows - i))),
+                tuile);
+      for (int k = 0; k < tuile.rows; ++k) {
+        memcpy(dest.ptr(j + k) + (colonne + i) * taille_pixel, tuile.ptr(k),
+               tuile.cols * taille_pixel);
+      }
+      relacherZone(zone);
+    }
+  }
+} // Fin copierTransposee
+
+/**
+ * Écrit l'image réduite. Les PPM sont écrits en flux, bande par bande ; les
+ * autres formats passent par imwrite, après une transposition dans une
+ * nouvelle zone projetée pour les seams lignes.
+ *
+ * @param image Image réduite, dans le sens du carving
+ * @param zone Zone projetée qui contient image, relâchée après chaque bande
+ * @param transposee Vrai si image est la transposée de l'image à écrire
+ * @param fichier Chemin de l'image à écrire
+ * @return true si l'écriture a réussi
+ */
+static bool ecrireImage(const Mat &image, const ZoneProjetee &zone,
+                        bool transposee, const string &fichier) {
+  int largeur = transposee ? image.rows : image.cols;
+  int hauteur = transposee ? image.cols : image.rows;
+  string extension = filesystem::path(fichier).extension().string();
+  transform(extension.begin(), extension.end(), extension.begin(),
+            [](unsigned char c) { return tolower(c); });
+
+  if (extension == ".ppm" || extension == ".pnm") {
+    FILE *sortie = fopen(fichier.c_str(), "wb");
+    if (!sortie) {
+      perror("Erreur d'ouverture de l'image de sortie");
+      return false;
+    }
+    bool reussi = fprintf(sortie, "P6\n%d %d\n255\n", largeur, hauteur) > 0;
+    for (int y = 0; reussi && y < hauteur; y += BANDE_HORS_MEMOIRE) {
+      int fin = min(y + BANDE_HORS_MEMOIRE, hauteur);
+      Mat bande;
+      if (transposee) {
+        bande.create(fin - y, largeur, CV_8UC3);
+        copierTransposee(image.colRange(y, fin), bande, 0, zone);
+      } else {
+        bande = image.rowRange(y, fin).clone();
+      }
+      // Le fichier est en RGB
+      for (int i = 0; i < bande.rows; ++i) {
+        uchar *pixel = bande.ptr(i);
+        for (int j = 0; j < largeur; ++j, pixel += 3) {
+          swap(pixel[0], pixel[2]);
+        }
+        reussi = reussi && fwrite(bande.ptr(i), 3, largeur, sortie) ==
+                               (size_t)largeur;
+      }
+      relacherZone(zone);
+    }
+    if (fclose(sortie) != 0 || !reussi) {
+      perror("Erreur d'écriture de l'image de sortie");
+      return false;
+    }
+    return true;
+  }
+
+  Mat a_ecrire = image;
+  ZoneProjetee zone_transposee;
+  if (transposee) {
+    if (!projeterZone(zone_transposee, (size_t)largeur * hauteur * 3)) {
+      return false;
+    }
+    a_ecrire = Mat(hauteur, largeur, CV_8UC3, zone_transposee.adresse);
+    for (int y = 0; y < image.rows; y += BANDE_HORS_MEMOIRE) {
+      int fin = min(y + BANDE_HORS_MEMOIRE, image.rows);
+      copierTransposee(image.rowRange(y, fin), a_ecrire, y, zone_transposee);
+      relacherZone(zone);
+    }
+  }
+  if (!imwrite(fichier, a_ecrire)) {
+    cerr << "Erreur d'écriture de l'image de sortie." << endl;
+    return false;
+  }
+  return true;
+} // Fin ecrireImage
+
+/**
+ * Calcule l'énergie de l'image par bandes, en deux passes : la première
+ * cherche les bornes de gx² + gy² sur toute l'image, la seconde calcule
+ * l'énergie de chaque bande avec la table de ces bornes. Le résultat est
+ * celui de filtreEnergie sur l'image entière en niveaux de gris.
+ *
+ * @param couleur Image couleur
+ * @param energie Reçoit l'énergie (CV_8U, déjà allouée)
+ * @param zone_couleur Zone projetée de couleur, relâchée après chaque bande
+ * @param zone_energie Zone projetée de energie, relâchée après chaque bande
+ */
+static void calculerEnergieBandes(const Mat &couleur, Mat &energie,
+                                  const ZoneProjetee &zone_couleur,
+                                  const ZoneProjetee &zone_energie) {
+  int rows = couleur.rows;
+  int carre_min = INT_MAX;
+  int carre_max = 0;
+  Mat table;
+
+  for (int passe = 0; passe < 2; ++passe) {
+    for (int y = 0; y < rows; y += BANDE_HORS_MEMOIRE) {
+      // Deux lignes de marge de chaque côté : le flou, puis le gradient
+      int fin = min(y + BANDE_HORS_MEMOIRE, rows);
+      int debut_gris = max(y - 2, 0);
+      int fin_gris = min(fin + 2, rows);
+      Mat gris;
+      cvtColor(couleur.rowRange(debut_gris, fin_gris), gris, COLOR_BGR2GRAY);
+
+      if (passe == 0) {
+        bornesEnergieBande(gris, y - debut_gris, fin - debut_gris, carre_min,
+                           carre_max);
+      } else {
+        Mat lignes = energie.rowRange(y, fin);
+        energieBande(gris, y - debut_gris, fin - debut_gris, table, carre_min,
+                     lignes);
+      }
+      relacherZone(zone_couleur);
+      relacherZone(zone_energie);
+    }
+    table = tableEnergie(carre_min, carre_max);
+  }
+} // Fin calculerEnergieBandes
+
+/**
+ * Réduit une image sans jamais la garder en entier en mémoire (voir
+ * horsmemoire.h), et enregistre l'image réduite dans repertoire.
+ *
+ * Le carving est celui de la matrice cumulative compacte (voir
+ * matriceCumulativeColsCompacte), seam par seam : les seams sont ceux d'un
+ * carving exact de l'image, l'image en niveaux de gris étant tirée de
+ * l'image couleur. L'image seamed n'est pas produite.
+ *
+ * @param source Chemin de l'image
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param nomImage Nom de l'image avec son extension
+ * @param repertoire Répertoire d'export de l'image réduite
+ * @param seam_type SEAM_ROWS ou SEAM_COLS
+ * @return true si l'image réduite a été enregistrée
+ */
+bool seamCarvingHorsMemoire(const string &source, int NB_TOUR,
+                            const string &nomImage, const string &repertoire,
+                            int seam_type) {
+  PROFIL_ETAPE("seamCarving");
+
+  if (seam_type != SEAM_COLS && seam_type != SEAM_ROWS) {
+    cerr << "Erreur : Type de seam invalide." << endl;
+    return false;
+  }
+
+  SourceImage src;
+  {
+    PROFIL_ETAPE("imread");
+    if (!ouvrirSource(source, src)) {
+      return false;
+    }
+  }
+
+  // Pour les seams lignes, on travaille sur la transposée
+  bool transposer = (seam_type == SEAM_ROWS);
+  int rows = transposer ? src.largeur : src.hauteur;
+  int cols = transposer ? src.hauteur : src.largeur;
+  if (NB_TOUR < 0 || NB_TOUR >= cols) {
+    cerr << "Erreur : Nombre de seams invalide (" << NB_TOUR
+         << "), le traitement hors mémoire ne fait que réduire." << endl;
+    if (src.fichier) {
+      fclose(src.fichier);
+    }
+    return false;
+  }
+
+  ZoneProjetee zone_couleur, zone_energie, zone_directions;
+  size_t pas_directions =
+      (cols + DIRECTIONS_PAR_OCTET - 1) / DIRECTIONS_PAR_OCTET;
+  if (!projeterZone(zone_couleur, (size_t)rows * cols * 3) ||
+      !projeterZone(zone_energie, (size_t)rows * cols) ||
+      !projeterZone(zone_directions, (size_t)rows * pas_directions)) {
+    if (src.fichier) {
+      fclose(src.fichier);
+    }
+    return false;
+  }
+  Mat couleur(rows, cols, CV_8UC3, zone_couleur.adresse);
+  Mat energie(rows, cols, CV_8U, zone_energie.adresse);
+
+  // Lecture de l'image, bande par bande
+  {
+    PROFIL_ETAPE("imread");
+    bool reussi = true;
+    for (int y = 0; reussi && y < src.hauteur; y += BANDE_HORS_MEMOIRE) {
+      int nb_lignes = min(BANDE_HORS_MEMOIRE, src.hauteur - y);
+      Mat bande;
+      reussi = lireBande(src, y, nb_lignes, bande);
+      if (!reussi) {
+        break;
+      }
+      if (transposer) {
+        copierTransposee(bande, couleur, y, zone_couleur);
+      } else {
+        for (int i = 0; i < nb_lignes; ++i) {
+          memcpy(couleur.ptr(y + i), bande.ptr(i), (size_t)cols * 3);
+        }
+      }
+      relacherZone(zone_couleur);
+    }
+    if (src.fichier) {
+      fclose(src.fichier);
+    }
+    src.image.release();
+    if (!reussi) {
+      return false;
+    }
+  }
+
+  {
+    PROFIL_ETAPE("energie");
+    calculerEnergieBandes(couleur, energie, zone_couleur, zone_energie);
+  }
+
+  // Carving seam par seam et bande par bande : les pages de chaque bande
+  // sont rendues au système dès qu'elle est traitée
+  SeamWorkspace ws;
+  if (!allouerWorkspace(ws, rows, cols, 1, true, zone_directions.adresse)) {
+    return false;
+  }
+  for (int tour = 0; tour < NB_TOUR; ++tour) {
+    {
+      PROFIL_ETAPE("matrice");
+      for (int y = 0; y < rows; y += BANDE_HORS_MEMOIRE) {
+        matriceCumulativeColsCompacte(energie, ws.m_cumul, ws.directions, y,
+                                      min(y + BANDE_HORS_MEMOIRE, rows));
+        relacherZone(zone_energie);
+        relacherZone(zone_directions);
+      }
+    }
+    {
+      PROFIL_ETAPE("chemin");
+      findWayColsCompacte(energie, ws.m_cumul, ws.directions, ws.way);
+      relacherZone(zone_directions);
+    }
+
+    PROFIL_ETAPE("suppression");
+    for (int y = 0; y < rows; y += BANDE_HORS_MEMOIRE) {
+      // Le chemin commence par la dernière ligne
+      int fin = min(y + BANDE_HORS_MEMOIRE, rows);
+      const int *way = ws.way + (rows - fin);
+      Mat lignes_couleur = couleur.rowRange(y, fin);
+      Mat lignes_energie = energie.rowRange(y, fin);
+      suppressionSeamColor(lignes_couleur, way, SEAM_COLS);
+      suppressionSeamGray(lignes_energie, way, SEAM_COLS);
+      relacherZone(zone_couleur);
+      relacherZone(zone_energie);
+    }
+    couleur = couleur(Rect(0, 0, couleur.cols - 1, rows));
+    energie = energie(Rect(0, 0, energie.cols - 1, rows));
+  }
+  compterSeamsProfil(NB_TOUR);
+  libererWorkspace(ws);
+
+  // Sauvegarde de l'image
+  PROFIL_ETAPE("imwrite");
+  string suffixe = (seam_type == SEAM_ROWS) ? "rows-" : "cols-";
+  string fichier_modifie = repertoire + "resized_" + suffixe + nomImage;
+  if (!ecrireImage(couleur, zone_couleur, transposer, fichier_modifie)) {
+    return false;
+  }
+  cout << "Image resized et enregistrée: " << fichier_modifie << endl;
+
+  return true;
+} // Fin seamCarvingHorsMemoire
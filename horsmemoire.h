@@ -0,0 +1,27 @@
+#ifndef HORSMEMOIRE_H
+#define HORSMEMOIRE_H
+
+#include <string>
+
+#include "seamcarving.h"
+
+/**
+ * Seam carving d'images trop grandes pour la mémoire.
+ *
+ * L'image couleur, son énergie et les directions de la matrice cumulative
+ * compacte sont rangées dans des fichiers temporaires projetés en mémoire
+ * (dans le répertoire temporaire du système, TMPDIR). Tout est lu, filtré,
+ * carvé et écrit par bandes de BANDE_HORS_MEMOIRE lignes, et les pages de
+ * chaque bande sont rendues au système dès qu'elle est traitée : la mémoire
+ * résidente dépend de la taille d'une bande, pas du nombre de lignes.
+ *
+ * Les images PPM et PGM binaires sont lues en flux, et les PPM écrits en
+ * flux ; les autres formats passent par imread et imwrite, qui décodent et
+ * encodent l'image entière.
+ */
+
+bool seamCarvingHorsMemoire(const std::string &source, int NB_TOUR,
+                            const std::string &nomImage,
+                            const std::string &repertoire, int seam_type);
+
+#endif
@@ -2,22 +2,276 @@
 #include <iostream>
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <tbb/global_control.h>
+#include <tbb/task_arena.h>
 
+#include "horsmemoire.h"
+#include "profil.h"
 #include "seamcarving.h"
+#include "serie.h"
+#include "serveur.h"
+#include "video.h"
 
 #define NB_PARAM 3
 
 using namespace std;
 using namespace cv;
 
+/**
+ * Affiche le bilan des étapes et écrit la trace, si demandés.
+ *
+ * @param profil Vrai pour afficher le bilan
+ * @param fichier_trace Fichier de trace, ou chaîne vide
+ * @return false si la trace n'a pas pu être écrite
+ */
+static bool terminerProfil(bool profil, const string &fichier_trace) {
+  if (profil) {
+    afficherProfil(cout);
+  }
+  if (!fichier_trace.empty()) {
+    if (!ecrireTrace(fichier_trace)) {
+      return false;
+    }
+    cout << "Trace enregistrée: " << fichier_trace << endl;
+  }
+  return true;
+} // Fin terminerProfil
+
 int main(int argc, char *argv[]) {
 
-  if (argc != NB_PARAM + 1) {
-    cerr << "Paramètre : chemin vers l'image, nombre de seams, type (1>cols, "
-            "2>rows, 3>both)"
+  // Mode serveur : ./main --serveur <socket> [options], sans image à lire
+  bool serveur = argc >= 3 && string(argv[1]) == "--serveur";
+
+  if (!serveur && argc < NB_PARAM + 1) {
+    cerr << "Paramètre : chemin vers l'image, nombre de seams (négatif pour "
+            "agrandir), type (1>cols, 2>rows, 3>both, 4>cols et rows sur la "
+            "même image) [options]"
+         << endl;
+    cerr << "Ou : --serveur <socket Unix, ou - pour l'entrée et la sortie "
+            "standard> [options]"
+         << endl;
+    cerr << "Options :" << endl;
+    cerr << "  --complet    Reconstruit la matrice cumulative à chaque seam"
+         << endl;
+    cerr << "  --threads N  Nombre de threads (par défaut : tous les coeurs)"
+         << endl;
+    cerr << "  --par-passe K  Retire K seams disjoints par matrice cumulative"
+         << endl;
+    cerr << "  --tranches N Réduction approchée : N tranches verticales carvées "
+            "en parallèle"
+         << endl;
+    cerr << "  --comparer   Compare la suppression par lots ou par tranches au "
+            "carving exact"
+         << endl;
+    cerr << "  --energie-locale  Recalcule l'énergie autour de chaque seam"
+         << endl;
+    cerr << "  --dp-compact Matrice cumulative compacte (16 fois moins de "
+            "mémoire)"
+         << endl;
+    cerr << "  --index      Enregistre l'ordre de suppression de tous les pixels"
+         << endl;
+    cerr << "  --depuis-index  Réduit l'image avec l'index déjà enregistré"
+         << endl;
+    cerr << "  --video      Le chemin est une vidéo ou un répertoire d'images"
+         << endl;
+    cerr << "  --pyramide N Réduction approchée : seams cherchés sur l'énergie "
+            "réduite N fois de moitié, puis affinés"
+         << endl;
+    cerr << "  --couloir L  Vidéo, pyramide et masque : demi-largeur du "
+            "couloir autour des seams guides ou de l'objet (0 : carving exact)"
+         << endl;
+    cerr << "  --serie      Le chemin est un répertoire ou une liste d'images, "
+            "réduites en un seul processus"
+         << endl;
+    cerr << "  --hors-memoire  Réduit l'image par bandes, via des fichiers "
+            "temporaires projetés en mémoire"
+         << endl;
+    cerr << "  --masque F   Retire l'objet désigné par l'image F (pixels non "
+            "nuls), au plus nb seams (0 : sans limite)"
+         << endl;
+    cerr << "  --sans-seamed  N'enregistre pas l'image avec les seams tracés"
+         << endl;
+    cerr << "  --profil     Affiche le temps passé dans chaque étape" << endl;
+    cerr << "  --trace F    Enregistre une trace Chrome (JSON) des étapes"
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // Lecture des options facultatives
+  SeamOptions options;
+  bool video = false;
+  bool hors_memoire = false;
+  bool serie = false;
+  string fichier_masque;
+  bool profil = false;
+  string fichier_trace;
+  int nb_threads = tbb::task_arena::automatic;
+  for (int i = serveur ? 3 : NB_PARAM + 1; i < argc; ++i) {
+    string option = argv[i];
+    if (option == "--complet") {
+      options.incremental = false;
+    } else if (option == "--threads" && i + 1 < argc) {
+      nb_threads = atoi(argv[++i]);
+      if (nb_threads < 1) {
+        cerr << "Nombre de threads invalide." << endl;
+        exit(EXIT_FAILURE);
+      }
+    } else if (option == "--par-passe" && i + 1 < argc) {
+      options.seams_par_passe = atoi(argv[++i]);
+      if (options.seams_par_passe < 1 ||
+          options.seams_par_passe > SEAMS_PAR_PASSE_MAX) {
+        cerr << "Nombre de seams par passe invalide." << endl;
+        exit(EXIT_FAILURE);
+      }
+    } else if (option == "--tranches" && i + 1 < argc) {
+      options.tranches = atoi(argv[++i]);
+      if (options.tranches < 1) {
+        cerr << "Nombre de tranches invalide." << endl;
+        exit(EXIT_FAILURE);
+      }
+    } else if (option == "--pyramide" && i + 1 < argc) {
+      options.pyramide = atoi(argv[++i]);
+      if (options.pyramide < 0 || options.pyramide > PYRAMIDE_NIVEAUX_MAX) {
+        cerr << "Nombre de niveaux de pyramide invalide." << endl;
+        exit(EXIT_FAILURE);
+      }
+    } else if (option == "--comparer") {
+      options.comparer = true;
+    } else if (option == "--energie-locale") {
+      options.energie_locale = true;
+    } else if (option == "--dp-compact") {
+      options.dp_compact = true;
+    } else if (option == "--index") {
+      options.creer_index = true;
+    } else if (option == "--depuis-index") {
+      options.depuis_index = true;
+    } else if (option == "--video") {
+      video = true;
+    } else if (option == "--serie") {
+      serie = true;
+    } else if (option == "--hors-memoire") {
+      hors_memoire = true;
+    } else if (option == "--masque" && i + 1 < argc) {
+      fichier_masque = argv[++i];
+    } else if (option == "--sans-seamed") {
+      options.image_seamed = false;
+    } else if (option == "--profil") {
+      profil = true;
+    } else if (option == "--trace" && i + 1 < argc) {
+      fichier_trace = argv[++i];
+      activerTrace();
+    } else if (option == "--couloir" && i + 1 < argc) {
+      options.largeur_couloir = atoi(argv[++i]);
+      if (options.largeur_couloir < 0) {
+        cerr << "Largeur de couloir invalide." << endl;
+        exit(EXIT_FAILURE);
+      }
+    } else {
+      cerr << "Option inconnue : " << option << endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  if (options.creer_index && options.depuis_index) {
+    cerr << "Les options --index et --depuis-index sont incompatibles." << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (options.dp_compact && (options.seams_par_passe > 1 || video)) {
+    cerr << "L'option --dp-compact retire un seam par passe, sur une image."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (hors_memoire && (video || options.creer_index || options.depuis_index ||
+                       options.energie_locale || options.seams_par_passe > 1)) {
+    cerr << "L'option --hors-memoire réduit une image seam par seam, sans "
+            "index ni énergie locale."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (options.tranches > 1 &&
+      (video || hors_memoire || options.creer_index || options.depuis_index ||
+       options.energie_locale || options.seams_par_passe > 1)) {
+    cerr << "L'option --tranches réduit une image seam par seam, sans index "
+            "ni énergie locale."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (serie && (video || hors_memoire || options.creer_index ||
+                options.depuis_index)) {
+    cerr << "L'option --serie réduit des images une à une, sans index." << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (options.pyramide > 0 &&
+      (video || hors_memoire || options.dp_compact ||
+       options.seams_par_passe > 1 || options.tranches > 1)) {
+    cerr << "L'option --pyramide cherche un seam par passe, sur une image en "
+            "mémoire, sans --dp-compact ni --tranches."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+  // Sans carving approché (une pyramide sans couloir est exacte), il n'y a
+  // rien à comparer
+  if (options.comparer &&
+      options.seams_par_passe == 1 && options.tranches == 1 &&
+      (options.pyramide == 0 || options.largeur_couloir == 0)) {
+    cerr << "L'option --comparer s'utilise avec --par-passe, --tranches ou "
+            "--pyramide."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (video && (options.creer_index || options.depuis_index)) {
+    cerr << "Les options d'index ne s'appliquent pas aux vidéos." << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (video && (!options.incremental || options.energie_locale ||
+                options.seams_par_passe > 1 || options.comparer ||
+                !options.image_seamed)) {
+    cerr << "L'option --video cherche chaque seam dans un couloir (--couloir), "
+            "sans --complet, --energie-locale, --par-passe, --comparer ni "
+            "--sans-seamed."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (!fichier_masque.empty() &&
+      (serveur || video || serie || hors_memoire || options.creer_index ||
+       options.depuis_index || options.comparer || options.energie_locale ||
+       options.dp_compact || options.seams_par_passe > 1 ||
+       options.tranches > 1 || options.pyramide > 0)) {
+    cerr << "L'option --masque cherche chaque seam exactement autour de "
+            "l'objet, sur une image, sans index ni option de boucle."
          << endl;
     exit(EXIT_FAILURE);
   }
+  if (serveur && (video || hors_memoire || serie || options.creer_index ||
+                  options.depuis_index || options.comparer)) {
+    cerr << "Le serveur réduit des images en mémoire, sans index ni "
+            "comparaison."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+  if (serveur && profil && string(argv[2]) == "-") {
+    cerr << "L'option --profil écrit sur la sortie standard, réservée aux "
+            "réponses du serveur."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  // Tous les calculs parallèles se font dans une arène de nb_threads threads
+  tbb::global_control limite(tbb::global_control::max_allowed_parallelism,
+                             nb_threads == tbb::task_arena::automatic
+                                 ? tbb::this_task_arena::max_concurrency()
+                                 : nb_threads);
+  tbb::task_arena arena(nb_threads);
+
+  // Serveur : les requêtes arrivent jusqu'à son arrêt, rien n'est écrit dans
+  // Images/. Il attend les clients hors de l'arène et n'y entre que pour
+  // carver
+  if (serveur) {
+    int nb_requetes = seamCarvingServeur(argv[2], options, arena);
+    if (!terminerProfil(profil, fichier_trace) || nb_requetes < 0) {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
 
   string nom_image;       // Nom de l'image original avec son extension (ex :
                           // nom_image.png)
@@ -28,6 +282,10 @@ int main(int argc, char *argv[]) {
   // On récupère un chemin d'accès vers l'image et on ne garde que le nom de
   // l'image avec son extension
   filesystem::path chemin_abs_img(argv[1]);
+  if (!chemin_abs_img.has_filename()) {
+    // Répertoire d'images donné avec un '/' final
+    chemin_abs_img = chemin_abs_img.parent_path();
+  }
   nom_image = chemin_abs_img.filename().string();
 
   // On ne garde que le nom de l'image sans l'extension afin de pouvoir créer un
@@ -45,20 +303,105 @@ int main(int argc, char *argv[]) {
     }
   }
 
-  // Création du répertoire pourtant le nom de l'image traité
-  if (!filesystem::exists(dir_path)) {
+  // Création du répertoire pourtant le nom de l'image traité (chaque image
+  // d'une série a le sien)
+  if (!serie && !filesystem::exists(dir_path)) {
     if (!filesystem::create_directory(dir_path)) {
       cerr << "Échec de la création du répertoire d'accueil." << endl;
       exit(EXIT_FAILURE);
     }
   }
 
-  // Lecture de l'image en couleurs (par défaut en BGR)
-  Mat image = imread(argv[1], IMREAD_COLOR);
+  int nb_seam = atoi(argv[2]); // nombre de seams
+  if (options.comparer && nb_seam < 0) {
+    cerr << "L'option --comparer mesure une réduction, pas un agrandissement."
+         << endl;
+    exit(EXIT_FAILURE);
+  }
+
+  int type_seam = atoi(argv[3]);
+
+  // Séquence d'images : traitée à part, image par image
+  if (video) {
+    if (type_seam != 1 && type_seam != 2) {
+      cerr << "Les vidéos se réduisent en colonnes (1) ou en lignes (2)."
+           << endl;
+      exit(EXIT_FAILURE);
+    }
+    int nb_images = arena.execute([&] {
+      return seamCarvingVideo(argv[1], nb_seam,
+                              type_seam == 1 ? SEAM_COLS : SEAM_ROWS,
+                              dir_path, options);
+    });
+    if (!terminerProfil(profil, fichier_trace) || nb_images < 0) {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  // Série d'images : un seul processus pour toutes
+  if (serie) {
+    vector<int> seam_types;
+    if (type_seam == 1 || type_seam == 3) {
+      seam_types.push_back(SEAM_COLS);
+    }
+    if (type_seam == 2 || type_seam == 3) {
+      seam_types.push_back(SEAM_ROWS);
+    }
+    if (type_seam == 4) {
+      seam_types.push_back(SEAM_BOTH);
+    }
+    int nb_images = arena.execute([&] {
+      return seamCarvingSerie(argv[1], nb_seam, seam_types, options);
+    });
+    if (!terminerProfil(profil, fichier_trace) || nb_images < 0) {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  // Image trop grande pour la mémoire : lue et traitée par bandes
+  if (hors_memoire) {
+    if (type_seam == 4) {
+      cerr << "L'option --hors-memoire réduit une image dans un sens à la "
+              "fois (1, 2 ou 3)."
+           << endl;
+      exit(EXIT_FAILURE);
+    }
+    bool reussi = arena.execute([&] {
+      bool ok = true;
+      if (type_seam == 1 || type_seam == 3) {
+        ok = seamCarvingHorsMemoire(argv[1], nb_seam, nom_image, dir_path,
+                                    SEAM_COLS);
+      }
+      if (ok && (type_seam == 2 || type_seam == 3)) {
+        ok = seamCarvingHorsMemoire(argv[1], nb_seam, nom_image, dir_path,
+                                    SEAM_ROWS);
+      }
+      return ok;
+    });
+    if (!terminerProfil(profil, fichier_trace) || !reussi) {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
+
+  Mat image, image_gray;
+  {
+    PROFIL_ETAPE("imread");
 
-  // Lecture de l'image avec le paramètre "IMREAD_GRAYSCALE" pour uniquement
-  // l'avoir en degrés de gris
-  Mat image_gray = imread(argv[1], IMREAD_GRAYSCALE);
+    // Lecture de l'image telle quelle, avec sa transparence et ses 16 bits
+    // par canal s'il y en a ; les autres types (flottants, deux canaux) sont
+    // lus en BGR sur 8 bits
+    image = imread(argv[1], IMREAD_UNCHANGED);
+    if (!image.empty() && !pixelPrisEnCharge(image.type())) {
+      image = imread(argv[1], IMREAD_COLOR);
+    }
+
+    // Lecture de l'image avec le paramètre "IMREAD_GRAYSCALE" pour uniquement
+    // l'avoir en degrés de gris
+    image_gray = imread(argv[1], IMREAD_GRAYSCALE);
+  }
 
   if (image.empty()) { // Vérification si l'image existe
     cerr << "Erreur de lecture de l'image (main)!" << endl;
@@ -67,30 +410,78 @@ int main(int argc, char *argv[]) {
 
   // ----------------------- Projet -----------------------
 
-  Mat img;
+  // Suppression d'objet : les seams passent par le masque jusqu'à le vider
+  if (!fichier_masque.empty()) {
+    if (nb_seam < 0 || type_seam < 1 || type_seam > 3) {
+      cerr << "L'option --masque retire au plus nb seams (0 : sans limite), "
+              "de type 1, 2 ou 3."
+           << endl;
+      exit(EXIT_FAILURE);
+    }
+    Mat masque;
+    {
+      PROFIL_ETAPE("imread");
+      masque = imread(fichier_masque, IMREAD_GRAYSCALE);
+    }
+    if (masque.empty()) {
+      cerr << "Erreur de lecture du masque " << fichier_masque << "." << endl;
+      exit(EXIT_FAILURE);
+    }
+    bool reussi = arena.execute([&] {
+      bool ok = true;
+      if (type_seam == 1 || type_seam == 3) {
+        ok = !seamCarvingMasque(image, image_gray, masque, nb_seam, nom_image,
+                                dir_path, SEAM_COLS, options)
+                  .empty();
+      }
+      if (ok && (type_seam == 2 || type_seam == 3)) {
+        ok = !seamCarvingMasque(image, image_gray, masque, nb_seam, nom_image,
+                                dir_path, SEAM_ROWS, options)
+                  .empty();
+      }
+      return ok;
+    });
+    if (!terminerProfil(profil, fichier_trace) || !reussi) {
+      return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+  }
 
-  int nb_seam = atoi(argv[2]); // nombre de seams
+  Mat img;
 
-  int type_seam = atoi(argv[3]);
+  // Un carving qui échoue (index absent ou invalide, nombre de seams ou type
+  // d'image non pris en charge) a déjà affiché son erreur
+  bool reussi = arena.execute([&] {
+    switch (type_seam) {
+    case 1:
+      img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
+                        dir_path, SEAM_COLS, options);
+      return !img.empty();
+    case 2:
+      img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
+                        dir_path, SEAM_ROWS, options);
+      return !img.empty();
+    case 3:
+      img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
+                        dir_path, SEAM_COLS, options);
+      if (img.empty()) {
+        return false;
+      }
+      img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
+                        dir_path, SEAM_ROWS, options);
+      return !img.empty();
+    case 4:
+      img = seamCarving(image, image_gray, nb_seam, nom_image, dir_path,
+                        SEAM_BOTH, options);
+      return !img.empty();
+    default:
+      cerr << "Type de seam invalide (" << type_seam << ")." << endl;
+      return false;
+    }
+  });
 
-  switch (type_seam) {
-  case 1:
-    img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
-                      dir_path, SEAM_COLS);
-    break;
-  case 2:
-    img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
-                      dir_path, SEAM_ROWS);
-    break;
-  case 3:
-    img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
-                      dir_path, SEAM_COLS);
-    img = seamCarving(image.clone(), image_gray.clone(), nb_seam, nom_image,
-                      dir_path, SEAM_ROWS);
-    break;
-  default:
-    break;
+  if (!terminerProfil(profil, fichier_trace) || !reussi) {
+    return EXIT_FAILURE;
   }
-
   return EXIT_SUCCESS;
 } // fin main
\ No newline at end of file
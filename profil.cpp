@@ -0,0 +1,188 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "profil.h"
+
+using namespace std;
+
+/**
+ * Passage dans une étape, pour la trace.
+ */
+struct Evenement {
+  const char *nom;
+  long long debut_ns;
+  long long duree_ns;
+};
+
+/**
+ * Passages enregistrés par un thread : chaque thread remplit le sien, sans
+ * verrou.
+ */
+struct TamponTrace {
+  int tid;
+  vector<Evenement> evenements;
+};
+
+static mutex verrou_profil;
+static atomic<bool> trace_active(false);
+static atomic<long long> seams_profil(0);
+static const chrono::steady_clock::time_point origine_profil =
+    chrono::steady_clock::now();
+static thread_local TamponTrace *tampon_local = nullptr;
+
+/**
+ * Liste des étapes, dans l'ordre de leur premier passage.
+ */
+static vector<EtapeProfil *> &etapesProfil() {
+  static vector<EtapeProfil *> etapes;
+  return etapes;
+} // Fin etapesProfil
+
+/**
+ * Tampons de trace de tous les threads.
+ */
+static vector<unique_ptr<TamponTrace>> &tamponsTrace() {
+  static vector<unique_ptr<TamponTrace>> tampons;
+  return tampons;
+} // Fin tamponsTrace
+
+EtapeProfil::EtapeProfil(const char *nom) : nom(nom) {
+  lock_guard<mutex> verrou(verrou_profil);
+  etapesProfil().push_back(this);
+}
+
+/**
+ * Ajoute un passage au total de l'étape, et à la trace si elle est active.
+ *
+ * @param etape Étape chronométrée
+ * @param debut Début du passage
+ */
+void terminerEtape(EtapeProfil &etape,
+                   chrono::steady_clock::time_point debut) {
+  auto fin = chrono::steady_clock::now();
+  long long duree =
+      chrono::duration_cast<chrono::nanoseconds>(fin - debut).count();
+  etape.duree_ns.fetch_add(duree, memory_order_relaxed);
+  etape.appels.fetch_add(1, memory_order_relaxed);
+
+  if (trace_active.load(memory_order_relaxed)) {
+    if (!tampon_local) {
+      lock_guard<mutex> verrou(verrou_profil);
+      tamponsTrace().push_back(make_unique<TamponTrace>());
+      tampon_local = tamponsTrace().back().get();
+      tampon_local->tid = (int)tamponsTrace().size();
+    }
+    tampon_local->evenements.push_back(
+        {etape.nom,
+         chrono::duration_cast<chrono::nanoseconds>(debut - origine_profil)
+             .count(),
+         duree});
+  }
+} // Fin terminerEtape
+
+/**
+ * Ajoute des seams au total utilisé pour les durées par seam du bilan.
+ *
+ * @param nb_seams Nombre de seams retirés ou insérés
+ */
+void compterSeamsProfil(long long nb_seams) {
+  seams_profil.fetch_add(nb_seams, memory_order_relaxed);
+} // Fin compterSeamsProfil
+
+/**
+ * Active l'enregistrement de chaque passage pour ecrireTrace.
+ */
+void activerTrace() { trace_active.store(true); } // Fin activerTrace
+
+/**
+ * Affiche le bilan des étapes : nombre de passages, durée totale, moyenne
+ * et durée par seam. Les étapes imbriquées sont comptées dans leur parent.
+ *
+ * @param sortie Flux de sortie
+ */
+void afficherProfil(ostream &sortie) {
+  // Regroupement des étapes de même nom
+  vector<const char *> noms;
+  vector<long long> durees, appels;
+  {
+    lock_guard<mutex> verrou(verrou_profil);
+    for (const EtapeProfil *etape : etapesProfil()) {
+      size_t i = 0;
+      while (i < noms.size() && string(noms[i]) != etape->nom) {
+        ++i;
+      }
+      if (i == noms.size()) {
+        noms.push_back(etape->nom);
+        durees.push_back(0);
+        appels.push_back(0);
+      }
+      durees[i] += etape->duree_ns.load();
+      appels[i] += etape->appels.load();
+    }
+  }
+  long long seams = seams_profil.load();
+
+  ios::fmtflags format = sortie.flags();
+  // Les largeurs des en-têtes comptent les octets des caractères accentués
+  sortie << left << setw(21) << "Étape" << right << setw(10) << "Appels"
+         << setw(14) << "Total (ms)" << setw(17) << "Moyenne (µs)"
+         << setw(17) << "Par seam (µs)" << endl;
+  sortie << fixed << setprecision(3);
+  for (size_t i = 0; i < noms.size(); ++i) {
+    if (appels[i] == 0) {
+      continue;
+    }
+    sortie << left << setw(20) << noms[i] << right << setw(10) << appels[i]
+           << setw(14) << durees[i] / 1e6 << setw(16)
+           << durees[i] / 1e3 / appels[i];
+    if (seams > 0) {
+      sortie << setw(16) << durees[i] / 1e3 / seams;
+    }
+    sortie << endl;
+  }
+  sortie << "Seams : " << seams << endl;
+  sortie.flags(format);
+} // Fin afficherProfil
+
+/**
+ * Écrit les passages enregistrés au format Chrome trace-event (un
+ * événement complet par passage, un fil par thread).
+ *
+ * @param fichier Chemin du fichier JSON
+ * @return true si l'écriture a réussi
+ */
+bool ecrireTrace(const string &fichier) {
+  FILE *sortie = fopen(fichier.c_str(), "w");
+  if (!sortie) {
+    perror("Erreur d'ouverture du fichier de trace");
+    return false;
+  }
+
+  lock_guard<mutex> verrou(verrou_profil);
+  fprintf(sortie, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+  bool premier = true;
+  for (const auto &tampon : tamponsTrace()) {
+    for (const Evenement &evenement : tampon->evenements) {
+      fprintf(sortie,
+              "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,"
+              "\"ts\":%.3f,\"dur\":%.3f}",
+              premier ? "" : ",", evenement.nom, tampon->tid,
+              evenement.debut_ns / 1e3, evenement.duree_ns / 1e3);
+      premier = false;
+    }
+  }
+  fprintf(sortie, "\n]}\n");
+
+  if (fclose(sortie) != 0) {
+    perror("Erreur d'écriture du fichier de trace");
+    return false;
+  }
+  return true;
+} // Fin ecrireTrace
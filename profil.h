@@ -0,0 +1,64 @@
+#ifndef PROFIL_H
+#define PROFIL_H
+
+#include <atomic>
+#include <chrono>
+#include <ostream>
+#include <string>
+
+/**
+ * Chronométrage des étapes du seam carving.
+ *
+ * PROFIL_ETAPE("nom") chronomètre la fin du bloc courant : la durée est
+ * ajoutée au total de l'étape, pour un coût de deux lectures d'horloge et de
+ * deux additions atomiques. Les mesures restent donc toujours actives ; le
+ * bilan est affiché par afficherProfil. Si la trace est activée, chaque
+ * passage est aussi enregistré pour ecrireTrace (format Chrome trace-event,
+ * lisible par Perfetto ou chrome://tracing).
+ *
+ * Les étapes sont placées hors des boucles parallèles : un passage dure au
+ * moins le temps d'un seam.
+ */
+
+/**
+ * Étape chronométrée. Chaque PROFIL_ETAPE en crée une, statique, enregistrée
+ * au premier passage ; les étapes de même nom sont regroupées dans le bilan.
+ */
+struct EtapeProfil {
+  const char *nom;
+  std::atomic<long long> duree_ns{0};
+  std::atomic<long long> appels{0};
+
+  explicit EtapeProfil(const char *nom);
+};
+
+void terminerEtape(EtapeProfil &etape,
+                   std::chrono::steady_clock::time_point debut);
+
+/**
+ * Chronomètre d'une étape, arrêté à la sortie du bloc.
+ */
+class ChronoEtape {
+public:
+  explicit ChronoEtape(EtapeProfil &etape)
+      : etape(etape), debut(std::chrono::steady_clock::now()) {}
+  ~ChronoEtape() { terminerEtape(etape, debut); }
+
+private:
+  EtapeProfil &etape;
+  std::chrono::steady_clock::time_point debut;
+};
+
+#define PROFIL_CONCAT2(a, b) a##b
+#define PROFIL_CONCAT(a, b) PROFIL_CONCAT2(a, b)
+#define PROFIL_ETAPE(nom)                                                      \
+  static EtapeProfil PROFIL_CONCAT(etape_profil_, __LINE__)(nom);              \
+  ChronoEtape PROFIL_CONCAT(chrono_profil_, __LINE__)(                         \
+      PROFIL_CONCAT(etape_profil_, __LINE__))
+
+void compterSeamsProfil(long long nb_seams);
+void activerTrace();
+void afficherProfil(std::ostream &sortie);
+bool ecrireTrace(const std::string &fichier);
+
+#endif
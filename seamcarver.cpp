@@ -0,0 +1,785 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <utility>
+#include <vector>
+
+#include "profil.h"
+#include "seamcarver.h"
+#include "seamcarving.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * Rend une image réduite sur place continue, sans la recopier.
+ *
+ * image est une vue en haut à gauche de tampon, dont les lignes ont gardé
+ * le pas de tampon. Les lignes sont ramenées bout à bout au début de tampon
+ * (chaque ligne recule, l'ordre croissant ne les écrase donc pas) et l'image
+ * rendue partage le buffer de tampon.
+ *
+ * @param image Image réduite
+ * @param tampon Image continue dont image est une vue
+ * @return Image continue, à la taille de image
+ */
+static Mat serrer(const Mat &image, const Mat &tampon) {
+  if (image.isContinuous()) {
+    return image;
+  }
+  if (image.data != tampon.data || !tampon.isContinuous()) {
+    return image.clone();
+  }
+  size_t ligne = image.cols * image.elemSize();
+  for (int i = 1; i < image.rows; ++i) {
+    memmove(tampon.data + i * ligne, image.ptr(i), ligne);
+  }
+  return tampon.reshape(0, 1)
+      .colRange(0, image.rows * image.cols)
+      .reshape(0, image.rows);
+} // Fin serrer
+
+/**
+ * @param options Options du seam carving (voir SeamOptions)
+ */
+SeamCarver::SeamCarver(const SeamOptions &options) : opts(options) {}
+
+SeamCarver::~SeamCarver() { libererWorkspace(ws); }
+
+/**
+ * Réduit (NB_TOUR positif) ou agrandit (NB_TOUR négatif) une image.
+ *
+ * L'image n'est pas modifiée : elle est copiée une fois, puis réduite sur
+ * place dans cette copie.
+ *
+ * @param image Image couleur (voir pixelPrisEnCharge)
+ * @param NB_TOUR Nombre de seams à retirer, ou à insérer s'il est négatif
+ * @param seam_type SEAM_ROWS, SEAM_COLS, ou SEAM_BOTH pour retirer NB_TOUR
+ * seams dans chaque sens (voir redimensionner2D)
+ * @param img_seamed Reçoit l'image avec les seams tracés, ou nullptr pour ne
+ * pas la calculer
+ * @param image_gray Image en niveaux de gris sur 8 bits ; vide, elle est
+ * tirée de image (voir imageGris)
+ * @return Image redimensionnée, vide en cas d'erreur
+ */
+Mat SeamCarver::redimensionner(const Mat &image, int NB_TOUR, int seam_type,
+                               Mat *img_seamed, const Mat &image_gray) {
+  Mat copie = image;
+  return carver(copie, false, image_gray, NB_TOUR, seam_type, img_seamed);
+} // Fin redimensionner
+
+/**
+ * Comme ci-dessus, mais le buffer de image est repris et réduit sur place
+ * (seams colonnes), sans aucune copie : l'image rendue le partage.
+ */
+Mat SeamCarver::redimensionner(Mat &&image, int NB_TOUR, int seam_type,
+                               Mat *img_seamed, const Mat &image_gray) {
+  Mat proprio = std::move(image);
+  return carver(proprio, true, image_gray, NB_TOUR, seam_type, img_seamed);
+} // Fin redimensionner
+
+/**
+ * Réduit une image dans les deux sens : nb_cols seams colonnes et nb_rows
+ * seams lignes, retirés de la même image.
+ *
+ * L'ordre des seams est choisi sur une image réduite (voir
+ * planifierSeams2D). Les deux sens partagent les mêmes buffers : l'image de
+ * travail, son énergie, calculée une seule fois et réduite avec elle, et
+ * l'espace de travail. Ils ne sont transposés qu'aux changements de sens.
+ *
+ * @param image Image couleur (voir pixelPrisEnCharge)
+ * @param nb_cols Nombre de seams colonnes à retirer
+ * @param nb_rows Nombre de seams lignes à retirer
+ * @param img_seamed Reçoit l'image d'origine avec tous les pixels retirés
+ * tracés, ou nullptr pour ne pas la calculer
+ * @param image_gray Image en niveaux de gris sur 8 bits ; vide, elle est
+ * tirée de image (voir imageGris)
+ * @return Image redimensionnée, vide en cas d'erreur
+ */
+Mat SeamCarver::redimensionner2D(const Mat &image, int nb_cols, int nb_rows,
+                                 Mat *img_seamed, const Mat &image_gray) {
+  Mat copie = image;
+  return carver2D(copie, false, image_gray, nb_cols, nb_rows, img_seamed);
+} // Fin redimensionner2D
+
+/**
+ * Calcule l'ordre de suppression de tous les pixels : l'image est réduite
+ * jusqu'à un pixel de large et chaque pixel reçoit le tour auquel il a été
+ * retiré (le dernier garde cols - 1). Pour les seams lignes, l'ordre est
+ * celui de l'image transposée, comme dans les fichiers d'index.
+ *
+ * @param image_gray Image en niveaux de gris
+ * @param seam_type SEAM_ROWS ou SEAM_COLS
+ * @return Ordre de suppression (CV_32S), vide en cas d'erreur
+ */
+Mat SeamCarver::ordreSuppression(const Mat &image_gray, int seam_type) {
+  if (image_gray.empty() ||
+      (seam_type != SEAM_COLS && seam_type != SEAM_ROWS)) {
+    cerr << "Erreur : Paramètres invalides (ordreSuppression)." << endl;
+    return Mat();
+  }
+  Mat gris;
+  if (seam_type == SEAM_ROWS) {
+    transpose(image_gray, gris);
+  } else {
+    gris = image_gray;
+  }
+
+  EnergieLocale locale;
+  Mat energie = calculerEnergie(gris, locale);
+  int nb_seams = gris.cols - 1;
+  Mat ordre(gris.size(), CV_32S, Scalar(nb_seams));
+  Mat vide;
+  SeamOptions options_carving = optionsCarving(false, nb_seams);
+  // Les tranches ne notent pas l'ordre de suppression de l'image entière
+  options_carving.tranches = 1;
+  if ((options_carving.seams_par_passe > 1 || options_carving.pyramide > 0) &&
+      opts.comparer) {
+    PROFIL_ETAPE("comparaison");
+    comparerCarving(vide, energie, opts.energie_locale ? &locale : nullptr,
+                    nb_seams, options_carving);
+  }
+  boucle(vide, energie, opts.energie_locale ? &locale : nullptr, nullptr,
+         &ordre, nb_seams, options_carving);
+  return ordre;
+} // Fin ordreSuppression
+
+/**
+ * Retire un objet désigné par un masque : les seams passent par ses pixels
+ * jusqu'à ce qu'il n'en reste aucun, et seules les colonnes autour de
+ * l'objet, à moins de opts.largeur_couloir de son cadre, sont calculées
+ * (voir boucleSeamsColsMasque). Les options de
+ * boucle (lots, tranches, pyramide, matrice compacte, énergie locale) ne
+ * s'appliquent pas : chaque seam est exact dans sa fenêtre.
+ *
+ * @param image Image couleur (voir pixelPrisEnCharge)
+ * @param masque Pixels à retirer (non nuls), CV_8UC1 à la taille de image
+ * @param seam_type SEAM_ROWS ou SEAM_COLS
+ * @param nb_max Nombre maximal de seams, 0 pour vider le masque
+ * @param img_seamed Reçoit l'image avec les seams tracés, ou nullptr
+ * @param image_gray Image en niveaux de gris sur 8 bits, ou vide
+ * @return Image sans l'objet, vide en cas d'erreur
+ */
+Mat SeamCarver::supprimerObjet(const Mat &image, const Mat &masque,
+                               int seam_type, int nb_max, Mat *img_seamed,
+                               const Mat &image_gray) {
+  if (image.empty() || (seam_type != SEAM_COLS && seam_type != SEAM_ROWS) ||
+      !pixelPrisEnCharge(image.type()) || nb_max < 0) {
+    cerr << "Erreur : Paramètres invalides (supprimerObjet)." << endl;
+    return Mat();
+  }
+  if (masque.size() != image.size() || masque.type() != CV_8UC1) {
+    cerr << "Erreur : Le masque doit être une image en niveaux de gris de la "
+            "taille de l'image."
+         << endl;
+    return Mat();
+  }
+  if (countNonZero(masque) == 0) {
+    cerr << "Erreur : Le masque est vide." << endl;
+    return Mat();
+  }
+
+  Mat gris = image_gray;
+  if (gris.empty()) {
+    gris = imageGris(image);
+  }
+
+  Mat image_reduce, masque_reduit, seamed;
+  {
+    PROFIL_ETAPE("copie");
+    if (seam_type == SEAM_ROWS) {
+      Mat gris_t;
+      transpose(image, image_reduce);
+      transpose(masque, masque_reduit);
+      transpose(gris, gris_t);
+      gris = gris_t;
+    } else {
+      image_reduce = image.clone();
+      masque_reduit = masque.clone();
+    }
+    if (img_seamed) {
+      seamed = image_reduce.clone();
+    }
+  }
+  Mat tampon = image_reduce;
+
+  Mat energie;
+  {
+    PROFIL_ETAPE("energie");
+    energie = filtreEnergie(gris);
+  }
+
+  // Un seam par passe, avec la matrice complète restreinte à la fenêtre
+  SeamOptions options_masque = opts;
+  options_masque.seams_par_passe = 1;
+  options_masque.dp_compact = false;
+  BilanSeams bilan;
+  if (!reserver(energie.rows, energie.cols, options_masque)) {
+    dernier_bilan = bilan;
+    return Mat();
+  }
+  auto debut = chrono::steady_clock::now();
+  bilan = boucleSeamsColsMasque(image_reduce, energie, masque_reduit,
+                                img_seamed ? &seamed : nullptr, nb_max,
+                                opts.largeur_couloir, ws);
+  bilan.duree_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - debut)
+          .count();
+  compterSeamsProfil(bilan.passes);
+  dernier_bilan = bilan;
+  if (bilan.passes == 0) {
+    return Mat();
+  }
+
+  Mat resized_image;
+  if (seam_type == SEAM_ROWS) {
+    PROFIL_ETAPE("copie");
+    transpose(image_reduce, resized_image);
+    if (img_seamed) {
+      Mat seamed_t;
+      transpose(seamed, seamed_t);
+      seamed = seamed_t;
+    }
+  } else {
+    resized_image = serrer(image_reduce, tampon);
+  }
+  if (img_seamed) {
+    *img_seamed = seamed;
+  }
+  return resized_image;
+} // Fin supprimerObjet
+
+/**
+ * Redimensionne une image à partir de son ordre de suppression, en une
+ * passe : les pixels retirés avant le tour NB_TOUR disparaissent, ou les
+ * -NB_TOUR premiers seams sont dupliqués si NB_TOUR est négatif. L'ordre,
+ * qui peut venir d'un fichier, est vérifié avant d'être utilisé (voir
+ * verifierOrdre).
+ *
+ * @param image Image couleur
+ * @param ordre Ordre de suppression (voir ordreSuppression)
+ * @param NB_TOUR Nombre de seams à retirer, ou à insérer s'il est négatif
+ * @param seam_type SEAM_ROWS ou SEAM_COLS
+ * @param img_seamed Reçoit l'image avec les seams tracés, ou nullptr
+ * @return Image redimensionnée, vide en cas d'erreur
+ */
+Mat SeamCarver::depuisOrdre(const Mat &image, const Mat &ordre, int NB_TOUR,
+                            int seam_type, Mat *img_seamed) {
+  if (image.empty() || (seam_type != SEAM_COLS && seam_type != SEAM_ROWS) ||
+      !pixelPrisEnCharge(image.type())) {
+    cerr << "Erreur : Paramètres invalides (depuisOrdre)." << endl;
+    return Mat();
+  }
+  Mat oriente;
+  if (seam_type == SEAM_ROWS) {
+    PROFIL_ETAPE("copie");
+    transpose(image, oriente);
+  } else {
+    oriente = image;
+  }
+  if (ordre.size() != oriente.size()) {
+    cerr << "Erreur : L'index ne correspond pas à la taille de l'image."
+         << endl;
+    return Mat();
+  }
+  {
+    PROFIL_ETAPE("index");
+    if (!verifierOrdre(ordre)) {
+      cerr << "Erreur : Index invalide (chaque ligne doit contenir chaque "
+              "tour de suppression une fois)."
+           << endl;
+      return Mat();
+    }
+  }
+  if (NB_TOUR <= -oriente.cols || NB_TOUR >= oriente.cols) {
+    cerr << "Erreur : Nombre de seams invalide (" << NB_TOUR << ")." << endl;
+    return Mat();
+  }
+
+  Mat resultat, seamed;
+  {
+    PROFIL_ETAPE("index");
+    if (img_seamed) {
+      seamed = seamsIndex(oriente, ordre, abs(NB_TOUR));
+    }
+    if (NB_TOUR < 0) {
+      resultat = agrandirIndex(oriente, ordre, -NB_TOUR);
+    } else {
+      resultat = redimensionnerIndex(oriente, ordre, NB_TOUR);
+    }
+  }
+
+  if (seam_type == SEAM_ROWS) {
+    PROFIL_ETAPE("copie");
+    Mat resultat_t, seamed_t;
+    transpose(resultat, resultat_t);
+    resultat = resultat_t;
+    if (img_seamed) {
+      transpose(seamed, seamed_t);
+      seamed = seamed_t;
+    }
+  }
+  if (img_seamed) {
+    *img_seamed = seamed;
+  }
+  return resultat;
+} // Fin depuisOrdre
+
+/**
+ * Seam carving d'une image (voir redimensionner).
+ *
+ * @param image Image couleur
+ * @param proprietaire Vrai si le buffer de image peut être réduit sur place
+ * @param image_gray Image en niveaux de gris, ou vide
+ * @param NB_TOUR Nombre de seams à retirer, ou à insérer s'il est négatif
+ * @param seam_type SEAM_ROWS, SEAM_COLS ou SEAM_BOTH
+ * @param img_seamed Reçoit l'image avec les seams tracés, ou nullptr
+ * @return Image redimensionnée, vide en cas d'erreur
+ */
+Mat SeamCarver::carver(Mat &image, bool proprietaire, const Mat &image_gray,
+                       int NB_TOUR, int seam_type, Mat *img_seamed) {
+  if (seam_type == SEAM_BOTH) {
+    return carver2D(image, proprietaire, image_gray, NB_TOUR, NB_TOUR,
+                    img_seamed);
+  }
+  if (image.empty()) {
+    cerr << "Erreur : Les images d'entrée sont vident." << endl;
+    return Mat();
+  }
+  if (seam_type != SEAM_COLS && seam_type != SEAM_ROWS) {
+    cerr << "Erreur : Type de seam invalide." << endl;
+    return Mat();
+  }
+  if (!pixelPrisEnCharge(image.type())) {
+    cerr << "Erreur : Type d'image non pris en charge." << endl;
+    return Mat();
+  }
+
+  // Il doit rester au moins un pixel après la suppression des seams, et les
+  // seams insérés (NB_TOUR négatif) doivent être disjoints
+  int dimension = (seam_type == SEAM_ROWS) ? image.rows : image.cols;
+  if (NB_TOUR <= -dimension || NB_TOUR >= dimension) {
+    cerr << "Erreur : Nombre de seams invalide (" << NB_TOUR << ")." << endl;
+    return Mat();
+  }
+  bool agrandir = NB_TOUR < 0;
+  int nb_seams = abs(NB_TOUR);
+
+  Mat gris = image_gray;
+  if (gris.empty()) {
+    gris = imageGris(image);
+  }
+
+  // Un seul buffer par image, réduit sur place à chaque seam. Pour les seams
+  // lignes, on travaille sur les transposées (l'énergie de la transposée est
+  // la transposée de l'énergie).
+  Mat image_reduce, seamed;
+  {
+    PROFIL_ETAPE("copie");
+    if (seam_type == SEAM_ROWS) {
+      Mat gris_t;
+      transpose(image, image_reduce);
+      transpose(gris, gris_t);
+      gris = gris_t;
+    } else if (proprietaire && image.isContinuous()) {
+      image_reduce = image;
+    } else {
+      image_reduce = image.clone();
+    }
+    image.release();
+    if (img_seamed && !agrandir) {
+      seamed = image_reduce.clone();
+    }
+  }
+  Mat tampon = image_reduce;
+
+  EnergieLocale locale;
+  Mat image_gradient = calculerEnergie(gris, locale);
+  EnergieLocale *p_locale = opts.energie_locale ? &locale : nullptr;
+
+  // Pour agrandir, seul l'ordre de suppression compte : l'image couleur n'est
+  // pas touchée et l'image agrandie en est tirée ensuite
+  SeamOptions options_carving = optionsCarving(agrandir, nb_seams);
+  Mat vide, ordre;
+  Mat &couleur = agrandir ? vide : image_reduce;
+  if (agrandir) {
+    // Les pixels jamais supprimés gardent l'ordre nb_seams
+    ordre = Mat(image_reduce.size(), CV_32S, Scalar(nb_seams));
+  }
+
+  // Comparaison avec le carving exact, avant de modifier les images
+  if ((options_carving.seams_par_passe > 1 || options_carving.tranches > 1 ||
+       options_carving.pyramide > 0) &&
+      opts.comparer) {
+    PROFIL_ETAPE("comparaison");
+    comparerCarving(image_reduce, image_gradient, p_locale, nb_seams,
+                    options_carving);
+  }
+
+  BilanSeams bilan = boucle(couleur, image_gradient, p_locale,
+                            (img_seamed && !agrandir) ? &seamed : nullptr,
+                            agrandir ? &ordre : nullptr, nb_seams,
+                            options_carving);
+  if (bilan.passes == 0 && nb_seams > 0) {
+    return Mat();
+  }
+
+  // Image agrandie tirée de l'ordre de suppression, en une passe
+  if (agrandir) {
+    PROFIL_ETAPE("index");
+    if (img_seamed) {
+      seamed = seamsIndex(image_reduce, ordre, nb_seams);
+    }
+    image_reduce = agrandirIndex(image_reduce, ordre, nb_seams);
+    tampon = image_reduce;
+  }
+
+  Mat resized_image;
+  if (seam_type == SEAM_ROWS) {
+    PROFIL_ETAPE("copie");
+    transpose(image_reduce, resized_image);
+    if (img_seamed) {
+      Mat seamed_t;
+      transpose(seamed, seamed_t);
+      seamed = seamed_t;
+    }
+  } else {
+    resized_image = serrer(image_reduce, tampon);
+  }
+  if (img_seamed) {
+    *img_seamed = seamed;
+  }
+  return resized_image;
+} // Fin carver
+
+/**
+ * Transpose l'état du carving dans les deux sens, pour passer des seams
+ * colonnes aux seams lignes ou l'inverse.
+ *
+ * @param couleur Image de travail
+ * @param tampon Reçoit le buffer de la nouvelle image de travail
+ * @param energie Énergie de l'image
+ * @param locale Énergie locale, ou nullptr
+ * @param positions Positions d'origine des pixels, ou vide
+ */
+static void transposerEtat(Mat &couleur, Mat &tampon, Mat &energie,
+                           EnergieLocale *locale, Mat &positions) {
+  PROFIL_ETAPE("transposition");
+  Mat t;
+  transpose(couleur, t);
+  couleur = tampon = t;
+  transpose(energie, t);
+  energie = t;
+  if (locale) {
+    transpose(locale->gris, t);
+    locale->gris = t;
+  }
+  if (!positions.empty()) {
+    transpose(positions, t);
+    positions = t;
+  }
+} // Fin transposerEtat
+
+/**
+ * Reporte les pixels retirés par une suite de seams sur l'image d'origine,
+ * puis retire ces pixels des positions d'origine.
+ *
+ * @param marque Pixels retirés par la suite (non nuls), à la taille des
+ * positions
+ * @param positions Position d'origine (i * cols + j) de chaque pixel de
+ * l'image de travail, réduite sur place
+ * @param retires Carte à la taille de l'image d'origine, mise à 0 pour
+ * chaque pixel retiré
+ */
+static void reporterRetires(const Mat &marque, Mat &positions, Mat &retires) {
+  PROFIL_ETAPE("imageSeamed");
+  // Chaque ligne perd autant de pixels
+  int restants = positions.cols;
+  const uchar *premiere = marque.ptr<uchar>(0);
+  for (int j = 0; j < marque.cols; ++j) {
+    restants -= premiere[j] != 0;
+  }
+  int *carte = retires.ptr<int>(0);
+  tbb::parallel_for(
+      tbb::blocked_range<int>(0, positions.rows, SUPPRESSION_GRAIN),
+      [&](const tbb::blocked_range<int> &r) {
+        for (int i = r.begin(); i < r.end(); ++i) {
+          const uchar *m = marque.ptr<uchar>(i);
+          int *p = positions.ptr<int>(i);
+          int k = 0;
+          for (int j = 0; j < positions.cols; ++j) {
+            if (m[j]) {
+              carte[p[j]] = 0;
+            } else {
+              p[k++] = p[j];
+            }
+          }
+        }
+      });
+  positions = positions(Rect(0, 0, restants, positions.rows));
+} // Fin reporterRetires
+
+/**
+ * Seam carving d'une image dans les deux sens (voir redimensionner2D).
+ *
+ * @param image Image couleur
+ * @param proprietaire Vrai si le buffer de image peut être réduit sur place
+ * @param image_gray Image en niveaux de gris, ou vide
+ * @param nb_cols Nombre de seams colonnes à retirer
+ * @param nb_rows Nombre de seams lignes à retirer
+ * @param img_seamed Reçoit l'image avec les pixels retirés tracés, ou nullptr
+ * @return Image redimensionnée, vide en cas d'erreur
+ */
+Mat SeamCarver::carver2D(Mat &image, bool proprietaire, const Mat &image_gray,
+                         int nb_cols, int nb_rows, Mat *img_seamed) {
+  if (image.empty()) {
+    cerr << "Erreur : Les images d'entrée sont vident." << endl;
+    return Mat();
+  }
+  if (!pixelPrisEnCharge(image.type())) {
+    cerr << "Erreur : Type d'image non pris en charge." << endl;
+    return Mat();
+  }
+  // Réduction seulement, en gardant au moins un pixel dans chaque sens
+  if (nb_cols < 0 || nb_cols >= image.cols) {
+    cerr << "Erreur : Nombre de seams invalide (" << nb_cols << ")." << endl;
+    return Mat();
+  }
+  if (nb_rows < 0 || nb_rows >= image.rows) {
+    cerr << "Erreur : Nombre de seams invalide (" << nb_rows << ")." << endl;
+    return Mat();
+  }
+
+  Mat gris = image_gray;
+  if (gris.empty()) {
+    gris = imageGris(image);
+  }
+  vector<pair<int, int>> plan;
+  {
+    PROFIL_ETAPE("plan");
+    plan = planifierSeams2D(gris, nb_cols, nb_rows);
+  }
+
+  // L'image d'origine n'est gardée que pour y tracer les pixels retirés
+  Mat couleur;
+  {
+    PROFIL_ETAPE("copie");
+    if (proprietaire && image.isContinuous() && !img_seamed) {
+      couleur = image;
+    } else {
+      couleur = image.clone();
+    }
+  }
+  Mat tampon = couleur;
+
+  EnergieLocale locale;
+  Mat energie = calculerEnergie(gris, locale);
+  EnergieLocale *p_locale = opts.energie_locale ? &locale : nullptr;
+  SeamOptions options_carving = optionsCarving(false, 0);
+
+  // Position d'origine de chaque pixel de l'image de travail, et carte des
+  // pixels retirés (0) à la taille de l'image d'origine
+  Mat positions, retires;
+  if (img_seamed) {
+    positions = Mat(image.size(), CV_32S);
+    for (int i = 0; i < image.rows; ++i) {
+      int *p = positions.ptr<int>(i);
+      for (int j = 0; j < image.cols; ++j) {
+        p[j] = i * image.cols + j;
+      }
+    }
+    retires = Mat(image.size(), CV_32S, Scalar(1));
+  }
+
+  BilanSeams total;
+  total.seams_par_passe = options_carving.seams_par_passe;
+  auto debut = chrono::steady_clock::now();
+  bool transposee = false;
+  for (const auto &suite : plan) {
+    if ((suite.first == SEAM_ROWS) != transposee) {
+      transposerEtat(couleur, tampon, energie, p_locale, positions);
+      transposee = !transposee;
+    }
+    Mat marque;
+    if (img_seamed) {
+      marque = Mat::zeros(energie.size(), CV_8U);
+    }
+    BilanSeams bilan =
+        boucle(couleur, energie, p_locale, img_seamed ? &marque : nullptr,
+               nullptr, suite.second, options_carving);
+    if (bilan.passes == 0) {
+      return Mat();
+    }
+    total.energie += bilan.energie;
+    total.passes += bilan.passes;
+    total.tranches = max(total.tranches, bilan.tranches);
+    if (img_seamed) {
+      reporterRetires(marque, positions, retires);
+    }
+  }
+  total.duree_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - debut)
+          .count();
+  dernier_bilan = total;
+
+  Mat resized_image;
+  if (transposee) {
+    PROFIL_ETAPE("copie");
+    transpose(couleur, resized_image);
+  } else {
+    resized_image = serrer(couleur, tampon);
+  }
+  if (img_seamed) {
+    PROFIL_ETAPE("imageSeamed");
+    *img_seamed = seamsIndex(image, retires, 1);
+  }
+  image.release();
+  return resized_image;
+} // Fin carver2D
+
+/**
+ * Options effectives d'une boucle de suppression.
+ *
+ * Pour agrandir, tous les seams à insérer sont tirés, si possible, d'une
+ * seule matrice cumulative. La matrice compacte ne permet qu'un seam par
+ * passe : elle l'emporte sur seams_par_passe. Les tranches ne servent qu'à
+ * réduire, sans énergie locale (elle couvrirait l'image entière). La
+ * pyramide ne sert qu'à réduire seam par seam, avec la matrice complète ;
+ * un couloir nul revient au carving exact.
+ *
+ * @param agrandir Vrai si les seams sont à insérer
+ * @param nb_seams Nombre de seams
+ * @return Options de la boucle
+ */
+SeamOptions SeamCarver::optionsCarving(bool agrandir, int nb_seams) const {
+  SeamOptions options_carving = opts;
+  if (opts.dp_compact) {
+    options_carving.seams_par_passe = 1;
+  } else if (agrandir && opts.seams_par_passe == 1) {
+    options_carving.seams_par_passe = nb_seams;
+  }
+  if (agrandir || opts.energie_locale) {
+    options_carving.tranches = 1;
+  }
+  if (agrandir || options_carving.seams_par_passe > 1 ||
+      options_carving.tranches > 1 || opts.dp_compact ||
+      opts.largeur_couloir <= 0) {
+    options_carving.pyramide = 0;
+  }
+  return options_carving;
+} // Fin optionsCarving
+
+/**
+ * Réserve l'espace de travail pour une image, en ne le réallouant que s'il
+ * est trop petit ou d'un autre mode. Il grandit alors jusqu'à la plus grande
+ * taille vue dans chaque dimension, pour ne pas être réalloué en alternance.
+ * Hors mode compact, seules la surface et la plus grande dimension comptent :
+ * l'espace d'une image sert aussi à sa transposée (voir carver2D).
+ *
+ * @param rows Nombre de lignes de l'image
+ * @param cols Nombre de colonnes de l'image
+ * @param options Options de la boucle (seams_par_passe, dp_compact)
+ * @return true si l'espace de travail est prêt
+ */
+bool SeamCarver::reserver(int rows, int cols, const SeamOptions &options) {
+  int seams_par_passe = options.seams_par_passe;
+  bool assez = options.dp_compact
+                   ? rows <= ws_rows && cols <= ws_cols
+                   : (size_t)rows * cols <= (size_t)ws_rows * ws_cols &&
+                         max(rows, cols) <= max(ws_rows, ws_cols);
+  if (ws.m_cumul && assez && seams_par_passe <= ws_lots &&
+      (seams_par_passe == 1 || ws.pris) && options.dp_compact == ws_compacte) {
+    return true;
+  }
+  if (options.dp_compact != ws_compacte) {
+    // Le mode change : la taille utile n'est plus la même
+    ws_rows = ws_cols = ws_lots = 0;
+  }
+  int nouv_rows = max(rows, ws_rows);
+  int nouv_cols = max(cols, ws_cols);
+  int nouv_lots = max(seams_par_passe, ws_lots);
+  ws_compacte = options.dp_compact;
+  if (!allouerWorkspace(ws, nouv_rows, nouv_cols, nouv_lots, ws_compacte)) {
+    ws_rows = ws_cols = ws_lots = 0;
+    return false;
+  }
+  ws_rows = nouv_rows;
+  ws_cols = nouv_cols;
+  ws_lots = nouv_lots;
+  return true;
+} // Fin reserver
+
+/**
+ * Boucle de suppression, exacte ou par lots selon options.seams_par_passe,
+ * par tranches selon options.tranches (chaque tranche a alors son propre
+ * espace de travail) ou du grossier au fin selon options.pyramide. Le bilan
+ * est aussi gardé pour bilan().
+ *
+ * @param couleur Image couleur réduite sur place, ou vide
+ * @param energie Énergie de l'image, réduite sur place
+ * @param locale Énergie locale tenue à jour, ou nullptr
+ * @param seamed Image sur laquelle les seams sont tracés, ou nullptr
+ * @param ordre Reçoit l'ordre de suppression, ou nullptr
+ * @param nb_seams Nombre de seams à retirer
+ * @param options Options du seam carving
+ * @return Bilan de la suppression (passes nul en cas d'erreur)
+ */
+BilanSeams SeamCarver::boucle(Mat &couleur, Mat &energie,
+                              EnergieLocale *locale, Mat *seamed, Mat *ordre,
+                              int nb_seams, const SeamOptions &options) {
+  BilanSeams bilan;
+  bilan.seams_par_passe = options.seams_par_passe;
+  if (options.tranches <= 1 &&
+      !reserver(energie.rows, energie.cols, options)) {
+    dernier_bilan = bilan;
+    return bilan;
+  }
+
+  auto debut = chrono::steady_clock::now();
+  BilanSeams boucle_bilan;
+  if (options.tranches > 1) {
+    boucle_bilan = boucleSeamsColsTranches(couleur, energie, seamed, nb_seams,
+                                           options.tranches, options);
+  } else if (options.seams_par_passe > 1) {
+    boucle_bilan = boucleSeamsColsParLots(couleur, energie, seamed, nb_seams,
+                                          ws, locale, ordre, options);
+  } else if (options.pyramide > 0) {
+    boucle_bilan = boucleSeamsColsPyramide(couleur, energie, seamed, nb_seams,
+                                           ws, locale, ordre, options);
+  } else {
+    boucle_bilan = boucleSeamsCols(couleur, energie, seamed, nb_seams, ws,
+                                   locale, ordre, options);
+  }
+  bilan.energie = boucle_bilan.energie;
+  bilan.passes = boucle_bilan.passes;
+  bilan.tranches = boucle_bilan.tranches;
+  bilan.duree_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - debut)
+          .count();
+  compterSeamsProfil(nb_seams);
+
+  dernier_bilan = bilan;
+  return bilan;
+} // Fin boucle
+
+/**
+ * Carte d'énergie de l'image, et énergie locale si elle est demandée.
+ *
+ * @param gris Image en niveaux de gris, dans le sens du carving
+ * @param locale Énergie locale, initialisée si opts.energie_locale
+ * @return Carte d'énergie
+ */
+Mat SeamCarver::calculerEnergie(const Mat &gris, EnergieLocale &locale) {
+  PROFIL_ETAPE("energie");
+  Mat energie;
+  if (opts.energie_locale) {
+    initEnergieLocale(locale, gris, energie);
+  } else {
+    energie = filtreEnergie(gris);
+  }
+  return energie;
+} // Fin calculerEnergie
@@ -0,0 +1,74 @@
+#ifndef SEAMCARVER_H
+#define SEAMCARVER_H
+
+#include <opencv2/opencv.hpp>
+
+#include "seamcarving.h"
+
+/**
+ * Seam carving en mémoire, sans aucun fichier ni message sur la sortie
+ * standard (seuls les erreurs et options.comparer écrivent).
+ *
+ * L'espace de travail (matrice cumulative, chemins, pixels pris) est gardé
+ * d'un appel à l'autre et n'est réalloué que si une image plus grande
+ * arrive : un même SeamCarver peut traiter de nombreuses images sans
+ * allocation de ce côté (sauf par tranches : chaque tranche a son propre
+ * espace, alloué à chaque appel). Les images rendues sont continues, à leur
+ * taille exacte. Un SeamCarver ne doit servir qu'à un thread à la fois.
+ *
+ * Les images sont en niveaux de gris, BGR ou BGRA, sur 8 ou 16 bits par
+ * canal (voir pixelPrisEnCharge) : le type est choisi une fois par image et
+ * les boucles sur les pixels sont instanciées pour chacun. Les seams lignes
+ * sont traités comme des seams colonnes sur les transposées ; une image
+ * réduite dans les deux sens (redimensionner2D) garde les mêmes buffers d'un
+ * sens à l'autre.
+ */
+class SeamCarver {
+public:
+  explicit SeamCarver(const SeamOptions &options = SeamOptions());
+  ~SeamCarver();
+  SeamCarver(const SeamCarver &) = delete;
+  SeamCarver &operator=(const SeamCarver &) = delete;
+
+  Mat redimensionner(const Mat &image, int NB_TOUR, int seam_type,
+                     Mat *img_seamed = nullptr,
+                     const Mat &image_gray = Mat());
+  Mat redimensionner(Mat &&image, int NB_TOUR, int seam_type,
+                     Mat *img_seamed = nullptr,
+                     const Mat &image_gray = Mat());
+  Mat redimensionner2D(const Mat &image, int nb_cols, int nb_rows,
+                       Mat *img_seamed = nullptr,
+                       const Mat &image_gray = Mat());
+  Mat supprimerObjet(const Mat &image, const Mat &masque, int seam_type,
+                     int nb_max = 0, Mat *img_seamed = nullptr,
+                     const Mat &image_gray = Mat());
+  Mat ordreSuppression(const Mat &image_gray, int seam_type);
+  Mat depuisOrdre(const Mat &image, const Mat &ordre, int NB_TOUR,
+                  int seam_type, Mat *img_seamed = nullptr);
+
+  const BilanSeams &bilan() const { return dernier_bilan; }
+  const SeamOptions &options() const { return opts; }
+  void changerOptions(const SeamOptions &options) { opts = options; }
+
+private:
+  Mat carver(Mat &image, bool proprietaire, const Mat &image_gray,
+             int NB_TOUR, int seam_type, Mat *img_seamed);
+  Mat carver2D(Mat &image, bool proprietaire, const Mat &image_gray,
+               int nb_cols, int nb_rows, Mat *img_seamed);
+  SeamOptions optionsCarving(bool agrandir, int nb_seams) const;
+  bool reserver(int rows, int cols, const SeamOptions &options);
+  BilanSeams boucle(Mat &couleur, Mat &energie, EnergieLocale *locale,
+                    Mat *seamed, Mat *ordre, int nb_seams,
+                    const SeamOptions &options);
+  Mat calculerEnergie(const Mat &gris, EnergieLocale &locale);
+
+  SeamOptions opts;
+  SeamWorkspace ws;
+  int ws_rows = 0;
+  int ws_cols = 0;
+  int ws_lots = 0;
+  bool ws_compacte = false;
+  BilanSeams dernier_bilan;
+};
+
+#endif
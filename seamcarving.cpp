@@ -1,10 +1,22 @@
 #include <algorithm>
+#include <chrono>
+#include <climits>
 #include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <limits>
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+#include <utility>
 
+#include "profil.h"
+#include "seamcarver.h"
 #include "seamcarving.h"
+#include "simd.h"
 
 using namespace cv;
 using namespace std;
@@ -139,437 +151,2943 @@ Mat filtreGradient(
   return edges.clone();
 } // fin filtreGradient
 
+/**
+ * Flou gaussien d'un pixel, avec le traitement des bords de filtreGaussien
+ * (les voisins hors de l'image sont ignorés).
+ *
+ * @param image Image en niveaux de gris
+ * @param y Ligne du pixel
+ * @param x Colonne du pixel
+ * @return Valeur floutée
+ */
+static inline uchar flouPixelBord(const Mat &image, int y, int x) {
+  static const int fenetre[3][3] = {{1, 2, 1}, {2, 4, 2}, {1, 2, 1}};
+
+  int som = 1;
+  for (int m = -1; m <= 1; m++) {
+    for (int n = -1; n <= 1; n++) {
+      int yy = y + m;
+      int xx = x + n;
+      if (xx >= 0 && xx < image.cols && yy >= 0 && yy < image.rows) {
+        som += fenetre[m + 1][n + 1] * image.at<uchar>(yy, xx);
+      }
+    }
+  }
+
+  return som / 16;
+} // Fin flouPixelBord
+
+/**
+ * Floute les colonnes [debut, fin) d'une ligne : noyau vectorisé à
+ * l'intérieur, pixels de bord traités à part.
+ *
+ * @param image Image en niveaux de gris
+ * @param y Ligne à flouter
+ * @param debut Première colonne
+ * @param fin Colonne de fin (exclue)
+ * @param sortie Ligne floutée, indexée comme l'image
+ */
+static void flouSegment(const Mat &image, int y, int debut, int fin,
+                        uchar *sortie) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  if (y == 0 || y == rows - 1 || cols < 3) {
+    for (int x = debut; x < fin; ++x) {
+      sortie[x] = flouPixelBord(image, y, x);
+    }
+    return;
+  }
+
+  if (debut == 0) {
+    sortie[0] = flouPixelBord(image, y, 0);
+  }
+  int debut_int = max(debut, 1);
+  int fin_int = min(fin, cols - 1);
+  if (debut_int < fin_int) {
+    flouLigneSimd(image.ptr<uchar>(y - 1), image.ptr<uchar>(y),
+                  image.ptr<uchar>(y + 1), sortie, debut_int, fin_int);
+  }
+  if (fin == cols) {
+    sortie[cols - 1] = flouPixelBord(image, y, cols - 1);
+  }
+} // Fin flouSegment
+
+/**
+ * Floute une ligne entière.
+ *
+ * @param image Image en niveaux de gris
+ * @param y Ligne à flouter
+ * @param sortie Ligne floutée (image.cols pixels)
+ */
+static void flouLigne(const Mat &image, int y, uchar *sortie) {
+  flouSegment(image, y, 0, image.cols, sortie);
+} // Fin flouLigne
+
+/**
+ * Calcule la magnitude du gradient de l'image floutée sur les lignes
+ * [debut, fin). Les lignes floutées nécessaires sont calculées au fur et à
+ * mesure dans un tampon tournant de trois lignes, qui reste en cache : le flou,
+ * la dérivation et la magnitude se font en une seule passe.
+ *
+ * @param image Image en niveaux de gris
+ * @param magnitude Magnitude du gradient (CV_32F), remplie sur [debut, fin)
+ * @param debut Première ligne
+ * @param fin Ligne de fin (exclue)
+ */
+static void magnitudeBande(const Mat &image, Mat &magnitude, int debut,
+                           int fin) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  vector<uchar> tampon(3 * cols);
+  auto ligneFloue = [&](int y) { return &tampon[(y % 3) * cols]; };
+  int prochaine = max(debut - 1, 0); // Prochaine ligne à flouter
+
+  for (int y = debut; y < fin; ++y) {
+    float *sortie = magnitude.ptr<float>(y);
+
+    // Le gradient est nul sur le bord de l'image
+    if (y == 0 || y == rows - 1 || cols < 3) {
+      fill(sortie, sortie + cols, 0.0f);
+      continue;
+    }
+
+    while (prochaine <= y + 1) {
+      flouLigne(image, prochaine, ligneFloue(prochaine));
+      ++prochaine;
+    }
+
+    sortie[0] = 0.0f;
+    magnitudeLigneSimd(ligneFloue(y - 1), ligneFloue(y), ligneFloue(y + 1),
+                       sortie, 1, cols - 1);
+    sortie[cols - 1] = 0.0f;
+  }
+} // Fin magnitudeBande
+
+/**
+ * Image en niveaux de gris sur 8 bits, d'où l'énergie est tirée, pour tout
+ * type d'image pris en charge (voir pixelPrisEnCharge). Une image déjà en
+ * niveaux de gris sur 8 bits est rendue telle quelle, sans copie.
+ *
+ * @param image Image en niveaux de gris, BGR ou BGRA, sur 8 ou 16 bits
+ * @return Image en niveaux de gris (CV_8UC1)
+ */
+Mat imageGris(const Mat &image) {
+  Mat gris = image;
+  if (image.channels() == 3) {
+    cvtColor(image, gris, COLOR_BGR2GRAY);
+  } else if (image.channels() == 4) {
+    cvtColor(image, gris, COLOR_BGRA2GRAY);
+  }
+  if (gris.depth() == CV_16U) {
+    // Comme imread, qui ramène les images 16 bits sur 8 bits
+    Mat gris8;
+    gris.convertTo(gris8, CV_8U, 1.0 / 256);
+    gris = gris8;
+  }
+  return gris;
+} // Fin imageGris
+
+/**
+ * Calcule la carte d'énergie d'une image en niveaux de gris.
+ *
+ * Donne exactement filtreGradient(filtreGaussien(image)), mais le flou, le
+ * gradient et la magnitude sont fusionnés en une passe vectorisée, découpée
+ * en bandes de lignes réparties sur les threads. Il ne reste ensuite que la
+ * normalisation [0,255] et la conversion sur 8 bits.
+ *
+ * @param image Image en niveaux de gris (sinon convertie, voir imageGris)
+ * @return Carte d'énergie (CV_8U)
+ */
+Mat filtreEnergie(const Mat &image) {
+  Mat gris = imageGris(image);
+
+  Mat magnitude(gris.size(), CV_32F);
+  tbb::parallel_for(tbb::blocked_range<int>(0, gris.rows, ENERGIE_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      magnitudeBande(gris, magnitude, r.begin(), r.end());
+                    });
+
+  // Normaliser les bords [0,255]
+  Mat energie;
+  normalize(magnitude, magnitude, 0, 255, NORM_MINMAX);
+  magnitude.convertTo(energie, CV_8U);
+
+  return energie;
+} // fin filtreEnergie
+
+/**
+ * Valeur entière gx² + gy² d'un pixel. La magnitude en est la racine, calculée
+ * en float : l'arrondi de son carré redonne exactement l'entier.
+ *
+ * @param magnitude Magnitude du gradient
+ * @return gx² + gy²
+ */
+static inline int carreMagnitude(float magnitude) {
+  return (int)lroundf(magnitude * magnitude);
+} // Fin carreMagnitude
+
+/**
+ * Calcule la magnitude du gradient sur les colonnes [debut, fin) d'une ligne,
+ * avec les mêmes noyaux que magnitudeBande.
+ *
+ * @param gris Image en niveaux de gris
+ * @param y Ligne
+ * @param debut Première colonne
+ * @param fin Colonne de fin (exclue)
+ * @param tampon Trois lignes floutées de gris.cols pixels (espace de travail)
+ * @param sortie Magnitude, indexée comme l'image
+ */
+static void magnitudeSegment(const Mat &gris, int y, int debut, int fin,
+                             uchar *tampon, float *sortie) {
+  int cols = gris.cols;
+
+  // Le gradient est nul sur le bord de l'image
+  int debut_int = max(debut, 1);
+  int fin_int = min(fin, cols - 1);
+  if (y == 0 || y == gris.rows - 1 || debut_int >= fin_int) {
+    fill(sortie + debut, sortie + fin, 0.0f);
+    return;
+  }
+  fill(sortie + debut, sortie + debut_int, 0.0f);
+  fill(sortie + fin_int, sortie + fin, 0.0f);
+
+  for (int k = 0; k < 3; ++k) {
+    flouSegment(gris, y - 1 + k, debut_int - 1, fin_int + 1,
+                tampon + k * cols);
+  }
+  magnitudeLigneSimd(tampon, tampon + cols, tampon + 2 * cols, sortie,
+                     debut_int, fin_int);
+} // Fin magnitudeSegment
+
+/**
+ * Table de l'énergie de chaque valeur de gx² + gy² entre deux bornes : toutes
+ * les magnitudes possibles entre les bornes passent par les mêmes normalize
+ * et convertTo que filtreEnergie. Si les bornes sont le minimum et le
+ * maximum de l'image, la table donne exactement l'énergie d'un calcul
+ * complet.
+ *
+ * @param carre_min Plus petite valeur de gx² + gy²
+ * @param carre_max Plus grande valeur de gx² + gy²
+ * @return Table (CV_8U, une ligne de carre_max - carre_min + 1 cases)
+ */
+Mat tableEnergie(int carre_min, int carre_max) {
+  Mat valeurs(1, carre_max - carre_min + 1, CV_32F);
+  float *v = valeurs.ptr<float>(0);
+  for (int c = carre_min; c <= carre_max; ++c) {
+    v[c - carre_min] = sqrt((float)c);
+  }
+  Mat table;
+  normalize(valeurs, valeurs, 0, 255, NORM_MINMAX);
+  valeurs.convertTo(table, CV_8U);
+  return table;
+} // Fin tableEnergie
+
+/**
+ * Étend les bornes de gx² + gy² aux lignes [debut, fin) d'une bande de
+ * l'image en niveaux de gris.
+ *
+ * La bande doit contenir deux lignes de marge de chaque côté de [debut, fin),
+ * sauf au bord de l'image : ses première et dernière lignes sont traitées
+ * comme les bords de l'image (gradient nul).
+ *
+ * @param gris Bande de l'image en niveaux de gris
+ * @param debut Première ligne de la bande à prendre en compte
+ * @param fin Ligne de fin (exclue)
+ * @param carre_min Borne inférieure, abaissée si besoin
+ * @param carre_max Borne supérieure, relevée si besoin
+ */
+void bornesEnergieBande(const Mat &gris, int debut, int fin, int &carre_min,
+                        int &carre_max) {
+  Mat magnitude(gris.size(), CV_32F);
+  tbb::parallel_for(tbb::blocked_range<int>(debut, fin, ENERGIE_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      magnitudeBande(gris, magnitude, r.begin(), r.end());
+                    });
+
+  for (int y = debut; y < fin; ++y) {
+    const float *m = magnitude.ptr<float>(y);
+    for (int x = 0; x < gris.cols; ++x) {
+      int carre = carreMagnitude(m[x]);
+      carre_min = min(carre_min, carre);
+      carre_max = max(carre_max, carre);
+    }
+  }
+} // Fin bornesEnergieBande
+
+/**
+ * Énergie des lignes [debut, fin) d'une bande de l'image en niveaux de gris,
+ * avec la table des bornes de toute l'image (voir tableEnergie) : le
+ * résultat est celui de filtreEnergie sur l'image entière.
+ *
+ * @param gris Bande de l'image en niveaux de gris, avec les marges de
+ * bornesEnergieBande
+ * @param debut Première ligne de la bande à calculer
+ * @param fin Ligne de fin (exclue)
+ * @param table Table de l'énergie
+ * @param carre_min Borne inférieure de la table
+ * @param energie Énergie des lignes (CV_8U, fin - debut lignes, déjà allouée)
+ */
+void energieBande(const Mat &gris, int debut, int fin, const Mat &table,
+                  int carre_min, Mat &energie) {
+  Mat magnitude(gris.size(), CV_32F);
+  const uchar *valeurs = table.ptr<uchar>(0);
+  tbb::parallel_for(tbb::blocked_range<int>(debut, fin, ENERGIE_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      magnitudeBande(gris, magnitude, r.begin(), r.end());
+                      for (int y = r.begin(); y < r.end(); ++y) {
+                        const float *m = magnitude.ptr<float>(y);
+                        uchar *e = energie.ptr<uchar>(y - debut);
+                        for (int x = 0; x < gris.cols; ++x) {
+                          e[x] = valeurs[carreMagnitude(m[x]) - carre_min];
+                        }
+                      }
+                    });
+} // Fin energieBande
+
+/**
+ * Reconstruit la table de l'énergie pour les bornes courantes, qui sont le
+ * minimum et le maximum de l'image : la table donne donc exactement
+ * l'énergie d'un calcul complet.
+ *
+ * @param el Énergie locale
+ */
+static void construireTableEnergie(EnergieLocale &el) {
+  el.table = tableEnergie(el.carre_min, el.carre_max);
+} // Fin construireTableEnergie
+
+/**
+ * Recalcule toute la carte d'énergie avec la table courante.
+ *
+ * @param el Énergie locale
+ * @param energie Carte d'énergie (CV_8U), de la taille de el.gris
+ * @param histogramme Si vrai, l'histogramme est aussi reconstruit
+ */
+static void quantifierEnergie(EnergieLocale &el, Mat &energie,
+                              bool histogramme) {
+  Mat magnitude(el.gris.size(), CV_32F);
+  tbb::parallel_for(
+      tbb::blocked_range<int>(0, el.gris.rows, ENERGIE_GRAIN),
+      [&](const tbb::blocked_range<int> &r) {
+        magnitudeBande(el.gris, magnitude, r.begin(), r.end());
+      });
+
+  if (histogramme) {
+    el.histogramme.assign(CARRE_GRADIENT_MAX + 1, 0);
+    for (int y = 0; y < magnitude.rows; ++y) {
+      const float *m = magnitude.ptr<float>(y);
+      for (int x = 0; x < magnitude.cols; ++x) {
+        ++el.histogramme[carreMagnitude(m[x])];
+      }
+    }
+    el.carre_min = 0;
+    while (el.histogramme[el.carre_min] == 0) {
+      ++el.carre_min;
+    }
+    el.carre_max = CARRE_GRADIENT_MAX;
+    while (el.histogramme[el.carre_max] == 0) {
+      --el.carre_max;
+    }
+    construireTableEnergie(el);
+  }
+
+  const uchar *table = el.table.ptr<uchar>(0);
+  tbb::parallel_for(tbb::blocked_range<int>(0, energie.rows, ENERGIE_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      for (int y = r.begin(); y < r.end(); ++y) {
+                        const float *m = magnitude.ptr<float>(y);
+                        uchar *e = energie.ptr<uchar>(y);
+                        for (int x = 0; x < energie.cols; ++x) {
+                          e[x] = table[carreMagnitude(m[x]) - el.carre_min];
+                        }
+                      }
+                    });
+} // Fin quantifierEnergie
+
+/**
+ * Calcule la carte d'énergie et l'état nécessaire pour la tenir à jour
+ * localement (voir majEnergieLocale). L'énergie obtenue est identique à
+ * celle de filtreEnergie.
+ *
+ * @param el Énergie locale à initialiser
+ * @param image Image en niveaux de gris
+ * @param energie Reçoit la carte d'énergie (CV_8U)
+ */
+void initEnergieLocale(EnergieLocale &el, const Mat &image, Mat &energie) {
+  el.gris = imageGris(image).clone();
+
+  energie.create(el.gris.size(), CV_8U);
+  quantifierEnergie(el, energie, true);
+} // Fin initEnergieLocale
+
+/**
+ * Met à jour l'énergie après la suppression de seams colonnes.
+ *
+ * Seuls les pixels à moins de ENERGIE_RAYON colonnes d'un seam supprimé
+ * voient leur voisinage changer : sur chaque ligne, le flou et le gradient
+ * sont recalculés sur cette bande avec les noyaux de filtreEnergie, le reste
+ * de l'énergie est simplement décalé. L'histogramme de gx² + gy² est tenu à
+ * jour (anciennes valeurs de la bande retirées, nouvelles ajoutées) et donne
+ * les bornes de la normalisation sans parcourir l'image ; l'énergie n'est
+ * recalculée en entier que si l'une d'elles change.
+ *
+ * @param el Énergie locale, réduite sur place
+ * @param energie Carte d'énergie, déjà réduite des seams
+ * @param ways Chemins supprimés, au format de findWaysColsDisjoints
+ * @param nb_seams Nombre de chemins
+ * @return true si toute l'énergie a été recalculée (bornes modifiées)
+ */
+bool majEnergieLocale(EnergieLocale &el, Mat &energie, const int *ways,
+                      int nb_seams) {
+  int rows = el.gris.rows;
+  int anciennes_cols = el.gris.cols;
+  int cols = anciennes_cols - nb_seams;
+
+  // Bandes de chaque ligne, dans l'image réduite : [debut, fin) contient les
+  // seams premier..dernier, soit [debut + premier, fin + dernier + 1) avant
+  // la suppression. decalage place la bande dans le tableau des carrés.
+  struct Bande {
+    int y, debut, fin, premier, dernier;
+    size_t decalage;
+  };
+  vector<Bande> bandes;
+  vector<int> positions(nb_seams);
+  size_t total = 0;
+  for (int y = 0; y < rows; ++y) {
+    for (int s = 0; s < nb_seams; ++s) {
+      positions[s] = ways[(size_t)s * rows + (rows - 1 - y)];
+    }
+    sort(positions.begin(), positions.end());
+
+    int s = 0;
+    while (s < nb_seams) {
+      // Bandes voisines fusionnées
+      Bande b = {y, max(positions[s] - s - ENERGIE_RAYON, 0),
+                 min(positions[s] - s + ENERGIE_RAYON + 1, cols), s, s, total};
+      for (++s; s < nb_seams && positions[s] - s - ENERGIE_RAYON <= b.fin;
+           ++s) {
+        b.fin = min(positions[s] - s + ENERGIE_RAYON + 1, cols);
+        b.dernier = s;
+      }
+      total += b.fin - b.debut + b.dernier - b.premier + 1;
+      bandes.push_back(b);
+    }
+  }
+
+  // gx² + gy² sur les bandes, avant ou après la suppression (les lignes sont
+  // indépendantes, seul l'histogramme est mis à jour séquentiellement)
+  vector<int> carres(total);
+  auto calculerCarres = [&](bool avant) {
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, bandes.size(), SUPPRESSION_GRAIN),
+        [&](const tbb::blocked_range<size_t> &r) {
+          vector<uchar> tampon(3 * anciennes_cols);
+          vector<float> magnitude(anciennes_cols);
+          for (size_t i = r.begin(); i < r.end(); ++i) {
+            const Bande &b = bandes[i];
+            int debut = avant ? b.debut + b.premier : b.debut;
+            int fin = avant ? b.fin + b.dernier + 1 : b.fin;
+            magnitudeSegment(el.gris, b.y, debut, fin, tampon.data(),
+                             magnitude.data());
+            for (int x = debut; x < fin; ++x) {
+              carres[b.decalage + x - debut] = carreMagnitude(magnitude[x]);
+            }
+          }
+        });
+  };
+
+  // Les anciennes valeurs des bandes (pixels supprimés compris) sortent de
+  // l'histogramme
+  calculerCarres(true);
+  for (const Bande &b : bandes) {
+    int largeur = b.fin - b.debut + b.dernier - b.premier + 1;
+    for (int x = 0; x < largeur; ++x) {
+      --el.histogramme[carres[b.decalage + x]];
+    }
+  }
+
+  suppressionSeamsCols(el.gris, ways, nb_seams);
+
+  // Les nouvelles valeurs y entrent et l'énergie de la bande est requantifiée
+  calculerCarres(false);
+  const uchar *table = el.table.ptr<uchar>(0);
+  int nouveau_min = el.carre_min;
+  int nouveau_max = el.carre_max;
+  for (const Bande &b : bandes) {
+    uchar *e = energie.ptr<uchar>(b.y);
+    for (int x = b.debut; x < b.fin; ++x) {
+      int carre = carres[b.decalage + x - b.debut];
+      ++el.histogramme[carre];
+      nouveau_min = min(nouveau_min, carre);
+      nouveau_max = max(nouveau_max, carre);
+      if (carre >= el.carre_min && carre <= el.carre_max) {
+        e[x] = table[carre - el.carre_min];
+      }
+    }
+  }
+
+  // Nouvelles bornes, lues dans l'histogramme
+  while (el.histogramme[nouveau_min] == 0) {
+    ++nouveau_min;
+  }
+  while (el.histogramme[nouveau_max] == 0) {
+    --nouveau_max;
+  }
+  if (nouveau_min == el.carre_min && nouveau_max == el.carre_max) {
+    return false;
+  }
+
+  el.carre_min = nouveau_min;
+  el.carre_max = nouveau_max;
+  construireTableEnergie(el);
+  quantifierEnergie(el, energie, false);
+  return true;
+} // Fin majEnergieLocale
+
+/**
+ * Alloue l'espace de travail pour une image de taille rows x cols.
+ *
+ * Tout est alloué en un seul bloc aligné, une seule fois, puis réutilisé pour
+ * chaque seam : la matrice cumulative est rangée de façon contiguë avec un pas
+ * égal à la largeur logique courante, qui diminue au fil des seams.
+ *
+ * @param ws Espace de travail à initialiser
+ * @param rows Nombre de lignes de l'image d'entrée
+ * @param cols Nombre de colonnes de l'image d'entrée
+ * @param seams_par_passe Nombre de chemins à conserver par passe ; au-delà
+ * de 1, la carte des pixels pris est aussi allouée
+ * @param compacte Vrai pour la matrice cumulative compacte (voir
+ * matriceCumulativeColsCompacte) : bande de DP_BANDE + 1 lignes et
+ * directions sur 2 bits au lieu de la matrice complète
+ * @param directions Mode compact : zone des directions fournie par
+ * l'appelant (par exemple projetée sur un fichier), ou nullptr pour
+ * l'allouer avec le reste
+ * @return true si l'allocation a réussi
+ */
+bool allouerWorkspace(SeamWorkspace &ws, int rows, int cols,
+                      int seams_par_passe, bool compacte,
+                      unsigned char *directions) {
+  libererWorkspace(ws);
+
+  // Taille arrondie à l'alignement, comme l'exige aligned_alloc
+  size_t taille_cumul =
+      (size_t)(compacte ? min(rows, DP_BANDE + 1) : rows) * cols * sizeof(int);
+  taille_cumul = (taille_cumul + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN *
+                 WORKSPACE_ALIGN;
+  size_t taille_way =
+      (size_t)max(rows, cols) * max(seams_par_passe, 1) * sizeof(int);
+  taille_way =
+      (taille_way + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN * WORKSPACE_ALIGN;
+  size_t taille_pris = (seams_par_passe > 1) ? (size_t)rows * cols : 0;
+  taille_pris =
+      (taille_pris + WORKSPACE_ALIGN - 1) / WORKSPACE_ALIGN * WORKSPACE_ALIGN;
+  size_t taille_directions =
+      (compacte && !directions)
+          ? (size_t)rows *
+                ((cols + DIRECTIONS_PAR_OCTET - 1) / DIRECTIONS_PAR_OCTET)
+          : 0;
+
+  ws.m_cumul = (int *)aligned_alloc(
+      WORKSPACE_ALIGN, taille_cumul + taille_way + taille_pris +
+                           (taille_directions + WORKSPACE_ALIGN - 1) /
+                               WORKSPACE_ALIGN * WORKSPACE_ALIGN);
+  if (!ws.m_cumul) {
+    perror("Erreur d'allocation mémoire pour l'espace de travail");
+    return false;
+  }
+  ws.way = ws.m_cumul + taille_cumul / sizeof(int);
+  if (taille_pris > 0) {
+    // La carte doit être vide au départ : chaque passe ne remet ensuite à
+    // zéro que les pixels qu'elle a marqués
+    ws.pris = (unsigned char *)ws.m_cumul + taille_cumul + taille_way;
+    memset(ws.pris, 0, taille_pris);
+  }
+  if (taille_directions > 0) {
+    ws.directions =
+        (unsigned char *)ws.m_cumul + taille_cumul + taille_way + taille_pris;
+  } else if (compacte) {
+    ws.directions = directions;
+  }
+  ws.rows = rows;
+  ws.cols = cols;
+
+  return true;
+} // Fin allouerWorkspace
+
+/**
+ * Libère l'espace de travail.
+ *
+ * @param ws Espace de travail (peut ne pas être alloué)
+ */
+void libererWorkspace(SeamWorkspace &ws) {
+  free(ws.m_cumul);
+  ws.m_cumul = nullptr;
+  ws.way = nullptr;
+  ws.pris = nullptr;
+  ws.directions = nullptr;
+  ws.rows = 0;
+  ws.cols = 0;
+} // Fin libererWorkspace
+
+/**
+ * Calcule une bande de lignes [debut, fin) de la matrice cumulative en
+ * parallèle, par triangles.
+ *
+ * La bande est découpée en tuiles de colonnes. Dans une première passe,
+ * chaque tuile calcule un trapèze qui se rétrécit d'une case de chaque côté
+ * par ligne : il ne dépend que de la ligne au-dessus de la bande et de
+ * lui-même, donc toutes les tuiles sont indépendantes. Une seconde passe
+ * remplit, aussi en parallèle, les triangles restés vides entre deux tuiles.
+ * Chaque case est calculée exactement comme dans la version séquentielle.
+ *
+ * @param image Image d'énergie
+ * @param m_cumul Matrice cumulative, complète jusqu'à la ligne debut - 1
+ * @param debut Première ligne de la bande (au moins 1)
+ * @param fin Ligne de fin de la bande (exclue)
+ * @param nb_tuiles Nombre de tuiles, chacune au moins 2 * (fin - debut) de
+ * large
+ */
+static void bandeCumulativeParallele(const Mat &image, int *m_cumul, int debut,
+                                     int fin, int nb_tuiles) {
+  int cols = image.cols;
+
+  // Passe 1 : trapèzes indépendants
+  tbb::parallel_for(0, nb_tuiles, [&](int t) {
+    int c0 = (int)((long long)t * cols / nb_tuiles);
+    int c1 = (int)((long long)(t + 1) * cols / nb_tuiles);
+    for (int i = debut, k = 0; i < fin; ++i, ++k) {
+      int a = (c0 == 0) ? 0 : c0 + k;
+      int b = (c1 == cols) ? cols : c1 - k;
+      ligneCumulativeSimd(m_cumul + (size_t)(i - 1) * cols,
+                          image.ptr<uchar>(i), m_cumul + (size_t)i * cols, a,
+                          b, cols);
+    }
+  });
+
+  // Passe 2 : triangles entre deux tuiles
+  tbb::parallel_for(1, nb_tuiles, [&](int t) {
+    int bord = (int)((long long)t * cols / nb_tuiles);
+    for (int i = debut, k = 0; i < fin; ++i, ++k) {
+      ligneCumulativeSimd(m_cumul + (size_t)(i - 1) * cols,
+                          image.ptr<uchar>(i), m_cumul + (size_t)i * cols,
+                          bord - k, bord + k, cols);
+    }
+  });
+} // Fin bandeCumulativeParallele
+
 /**
  * Crée la matrice cumulative en partant du haut vers le bas.
  * Adapté à un seam colonnes.
  *
- * @param image Image d'entrée
- * @return Matrice cumulative
+ * La matrice est rangée ligne par ligne : m_cumul[i * image.cols + j].
+ * Sur les grandes images, le calcul est réparti sur les threads TBB
+ * (voir bandeCumulativeParallele) ; le résultat est identique.
+ *
+ * @param image Image d'entrée
+ * @param m_cumul Matrice cumulative à remplir (au moins rows x cols cases)
+ */
+void matriceCumulativeCols(const Mat &image, int *m_cumul) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  // Initialisation de la première ligne
+  const uchar *energie = image.ptr<uchar>(0);
+  for (int j = 0; j < cols; ++j) {
+    m_cumul[j] = energie[j];
+  }
+
+  // Calcul parallèle par bandes si l'image est assez large
+  int nb_tuiles = cols / DP_TUILE;
+  if (nb_tuiles >= 2 && tbb::this_task_arena::max_concurrency() > 1) {
+    for (int i = 1; i < rows; i += DP_BANDE) {
+      bandeCumulativeParallele(image, m_cumul, i, min(i + DP_BANDE, rows),
+                               nb_tuiles);
+    }
+    return;
+  }
+
+  // Calcul de la matrice cumulative
+  for (int i = 1; i < rows; ++i) {
+    ligneCumulativeSimd(m_cumul + (size_t)(i - 1) * cols, image.ptr<uchar>(i),
+                        m_cumul + (size_t)i * cols, 0, cols, cols);
+  }
+} // Fin matriceCumulativeCols
+
+/**
+ * Crée la matrice cumulative (seam colonnes) sans la garder en entier.
+ *
+ * Les lignes sont calculées par bandes de DP_BANDE dans un tampon glissant
+ * de DP_BANDE + 1 lignes (la dernière ligne de la bande précédente, puis la
+ * bande), avec le même calcul parallèle que matriceCumulativeCols. De chaque
+ * bande, on ne garde que les directions de remontée de chaque pixel, sur 2
+ * bits : la mémoire passe de 4 octets à un quart d'octet par pixel.
+ * findWayColsCompacte remonte ensuite exactement le même chemin que
+ * findWayCols.
+ *
+ * @param image Image d'énergie
+ * @param bande Tampon d'au moins min(rows, DP_BANDE + 1) x cols cases ; la
+ * dernière ligne de la matrice cumulative s'y trouve en tête au retour
+ * @param directions Directions de remontée, rows lignes de
+ * (cols + 3) / 4 octets (la ligne 0 n'est pas utilisée)
+ */
+void matriceCumulativeColsCompacte(const Mat &image, int *bande,
+                                   unsigned char *directions) {
+  matriceCumulativeColsCompacte(image, bande, directions, 0, image.rows);
+} // Fin matriceCumulativeColsCompacte
+
+/**
+ * Comme ci-dessus, pour les lignes [debut, fin) seulement : la matrice peut
+ * être calculée en plusieurs appels successifs, par exemple pour ne lire
+ * qu'une partie de l'image à la fois.
+ *
+ * @param image Image d'énergie
+ * @param bande Tampon de la version complète ; si debut > 0, la ligne
+ * debut - 1 de la matrice cumulative doit s'y trouver en tête (comme au
+ * retour de l'appel précédent)
+ * @param directions Directions de remontée
+ * @param debut Première ligne à calculer
+ * @param fin Ligne de fin (exclue)
+ */
+void matriceCumulativeColsCompacte(const Mat &image, int *bande,
+                                   unsigned char *directions, int debut,
+                                   int fin) {
+  int cols = image.cols;
+  size_t pas = (cols + DIRECTIONS_PAR_OCTET - 1) / DIRECTIONS_PAR_OCTET;
+
+  if (debut == 0) {
+    const uchar *energie = image.ptr<uchar>(0);
+    for (int j = 0; j < cols; ++j) {
+      bande[j] = energie[j];
+    }
+    debut = 1;
+  }
+
+  int nb_tuiles = cols / DP_TUILE;
+  bool parallele =
+      nb_tuiles >= 2 && tbb::this_task_arena::max_concurrency() > 1;
+  for (int i = debut; i < fin; i += DP_BANDE) {
+    // Lignes i - 1 à fin_bande - 1 de l'image dans les lignes 0 à n du tampon
+    int fin_bande = min(i + DP_BANDE, fin);
+    int n = fin_bande - i;
+    Mat lignes = image.rowRange(i - 1, fin_bande);
+    if (parallele) {
+      bandeCumulativeParallele(lignes, bande, 1, n + 1, nb_tuiles);
+    } else {
+      for (int k = 1; k <= n; ++k) {
+        ligneCumulativeSimd(bande + (size_t)(k - 1) * cols,
+                            lignes.ptr<uchar>(k), bande + (size_t)k * cols, 0,
+                            cols, cols);
+      }
+    }
+
+    // Directions de chaque ligne de la bande, indépendantes entre elles
+    tbb::parallel_for(tbb::blocked_range<int>(1, n + 1, 8),
+                      [&](const tbb::blocked_range<int> &r) {
+                        for (int k = r.begin(); k < r.end(); ++k) {
+                          directionsLigneSimd(bande + (size_t)(k - 1) * cols,
+                                              directions + (i - 1 + k) * pas,
+                                              cols);
+                        }
+                      });
+
+    memcpy(bande, bande + (size_t)n * cols, cols * sizeof(int));
+  }
+} // Fin matriceCumulativeColsCompacte
+
+/**
+ * Crée la matrice cumulative (seam colonnes) dans un couloir autour d'un
+ * chemin connu, par exemple le seam de même rang de l'image précédente d'une
+ * séquence. Sur chaque ligne, seules les colonnes à moins de largeur du
+ * chemin sont calculées ; deux cases de chaque côté du couloir reçoivent
+ * INT_MAX, ce qui suffit puisque le couloir se décale d'au plus une colonne
+ * par ligne. Le coût est en O(rows x largeur) au lieu de O(rows x cols).
+ *
+ * @param image Image d'énergie
+ * @param m_cumul Matrice cumulative, au même format que matriceCumulativeCols
+ * @param centre Chemin central (du bas vers le haut, comme way)
+ * @param largeur Demi-largeur du couloir (au moins 1)
+ */
+void matriceCumulativeColsCouloir(const Mat &image, int *m_cumul,
+                                  const int *centre, int largeur) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  for (int i = 0; i < rows; ++i) {
+    int c = min(max(centre[rows - 1 - i], 0), cols - 1);
+    int debut = max(c - largeur, 0);
+    int fin = min(c + largeur + 1, cols);
+    int *courant = m_cumul + (size_t)i * cols;
+
+    if (i == 0) {
+      const uchar *energie = image.ptr<uchar>(0);
+      for (int j = debut; j < fin; ++j) {
+        courant[j] = energie[j];
+      }
+    } else {
+      ligneCumulativeSimd(courant - cols, image.ptr<uchar>(i), courant, debut,
+                          fin, cols);
+    }
+
+    for (int j = max(debut - 2, 0); j < debut; ++j) {
+      courant[j] = INT_MAX;
+    }
+    for (int j = fin; j < min(fin + 2, cols); ++j) {
+      courant[j] = INT_MAX;
+    }
+  }
+} // Fin matriceCumulativeColsCouloir
+
+/**
+ * Crée la matrice cumulative en partant de gauche vers la droite.
+ * Adapté à un seam ligne.
+ *
+ * La matrice est rangée colonne par colonne : m_cumul[j * image.rows + i],
+ * pour que le calcul d'une colonne lise la précédente de façon contiguë.
+ *
+ * @param image Image d'entrée
+ * @param m_cumul Matrice cumulative à remplir (au moins rows x cols cases)
+ */
+void matriceCumulativeRows(const Mat &image, int *m_cumul) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  // Colonne d'énergie recopiée de façon contiguë pour le noyau vectorisé
+  vector<uchar> energie(rows);
+
+  // Initialisation de la première colonne
+  for (int i = 0; i < rows; ++i) {
+    m_cumul[i] = image.at<uchar>(i, 0);
+  }
+
+  // Calcul de la matrice cumulative
+  for (int j = 1; j < cols; ++j) {
+    for (int i = 0; i < rows; ++i) {
+      energie[i] = image.at<uchar>(i, j);
+    }
+    ligneCumulativeSimd(m_cumul + (size_t)(j - 1) * rows, energie.data(),
+                        m_cumul + (size_t)j * rows, 0, rows, rows);
+  }
+} // Fin matriceCumulativeRows
+
+/**
+ * Met à jour une matrice cumulative rangée par tranches (lignes pour un seam
+ * colonnes, colonnes pour un seam lignes) après la suppression d'un seam.
+ *
+ * Chaque tranche est recopiée au nouveau pas, sans la case du seam. Une case
+ * ne peut changer que si ses voisines de la tranche précédente ont changé de
+ * place (autour du seam) ou de valeur : on ne recalcule donc que cet
+ * intervalle, qui s'élargit d'au plus une case de chaque côté par tranche et
+ * se resserre dès que les valeurs recalculées redeviennent les anciennes.
+ *
+ * @param energie Énergie du pixel (tranche t, position p) après suppression
+ * @param m_cumul Matrice cumulative, au pas longueur + 1 en entrée et au pas
+ * longueur en sortie
+ * @param way Chemin supprimé, tranche par tranche en partant de la dernière
+ * @param nb_tranches Nombre de tranches
+ * @param longueur Nouvelle longueur d'une tranche
+ */
+template <typename Energie>
+static void majMatriceCumulative(Energie energie, int *m_cumul, const int *way,
+                                 int nb_tranches, int longueur) {
+  // Intervalle des cases modifiées sur la tranche précédente (vide au départ)
+  int debut_modif = 0;
+  int fin_modif = -1;
+
+  int seam_prec = way[nb_tranches - 1];
+
+  for (int t = 0; t < nb_tranches; ++t) {
+    int seam = way[nb_tranches - 1 - t];
+
+    // Recopie au nouveau pas : les cases hors intervalle sont déjà justes
+    const int *ancienne = m_cumul + (size_t)t * (longueur + 1);
+    int *courant = m_cumul + (size_t)t * longueur;
+    memmove(courant, ancienne, seam * sizeof(int));
+    memmove(courant + seam, ancienne + seam + 1,
+            (longueur - seam) * sizeof(int));
+
+    // La première tranche est l'énergie elle-même : la recopie suffit
+    if (t == 0) {
+      continue;
+    }
+    const int *prec = courant - longueur;
+
+    // Cases dont les voisines précédentes ont changé de place
+    int debut = min(seam, seam_prec) - 1;
+    int fin = max(seam, seam_prec);
+
+    // Cases dont les voisines précédentes ont changé de valeur
+    if (debut_modif <= fin_modif) {
+      debut = min(debut, debut_modif - 1);
+      fin = max(fin, fin_modif + 1);
+    }
+    debut = max(debut, 0);
+    fin = min(fin, longueur - 1);
+
+    debut_modif = longueur;
+    fin_modif = -1;
+    for (int p = debut; p <= fin; ++p) {
+      int min_prev = prec[p];
+      if (p > 0) {
+        min_prev = min(min_prev, prec[p - 1]);
+      }
+      if (p < longueur - 1) {
+        min_prev = min(min_prev, prec[p + 1]);
+      }
+
+      int valeur = energie(t, p) + min_prev;
+      if (valeur != courant[p]) {
+        courant[p] = valeur;
+        debut_modif = min(debut_modif, p);
+        fin_modif = p;
+      }
+    }
+
+    seam_prec = seam;
+  }
+} // Fin majMatriceCumulative
+
+/**
+ * Met à jour la matrice cumulative (seam colonnes) après la suppression d'un
+ * seam, au lieu de la reconstruire entièrement. Le résultat est identique à
+ * matriceCumulativeCols sur la nouvelle image.
+ *
+ * @param image Image d'énergie après suppression du seam (nouvelle largeur)
+ * @param m_cumul Matrice cumulative du tour précédent, mise à jour sur place
+ * @param way Chemin supprimé, tel que retourné par findWayCols
+ */
+void majMatriceCumulativeCols(const Mat &image, int *m_cumul, const int *way) {
+  const uchar *energie = image.ptr<uchar>(0);
+  size_t pas = image.step;
+  majMatriceCumulative(
+      [energie, pas](int i, int j) { return (int)energie[i * pas + j]; },
+      m_cumul, way, image.rows, image.cols);
+} // Fin majMatriceCumulativeCols
+
+/**
+ * Met à jour la matrice cumulative (seam lignes) après la suppression d'un
+ * seam. Le résultat est identique à matriceCumulativeRows sur la nouvelle
+ * image.
+ *
+ * @param image Image d'énergie après suppression du seam (nouvelle hauteur)
+ * @param m_cumul Matrice cumulative du tour précédent, mise à jour sur place
+ * @param way Chemin supprimé, tel que retourné par findWayRows
+ */
+void majMatriceCumulativeRows(const Mat &image, int *m_cumul, const int *way) {
+  const uchar *energie = image.ptr<uchar>(0);
+  size_t pas = image.step;
+  majMatriceCumulative(
+      [energie, pas](int j, int i) { return (int)energie[i * pas + j]; },
+      m_cumul, way, image.cols, image.rows);
+} // Fin majMatriceCumulativeRows
+
+/**
+ * Remonte le chemin minimal ligne par ligne à partir de sa colonne dans la
+ * dernière ligne (way[0]).
+ *
+ * @param m_cumul Matrice cumulative adaptée à la suppression de colonnes
+ * @param rows Nombre de lignes
+ * @param cols Nombre de colonnes
+ * @param way Tableau de taille rows, way[0] déjà rempli
+ */
+static void remonterWayCols(const int *m_cumul, int rows, int cols,
+                            int *way) {
+  for (int i = rows - 2, k = 1; i >= 0; --i, ++k) {
+    const int *ligne = m_cumul + (size_t)i * cols;
+    int prev_col = way[k - 1];
+    int min_col = prev_col; // Par défaut, la colonne actuelle est le minimum
+    int min_val = ligne[prev_col];
+
+    // Vérifier les colonnes adjacentes
+    for (int offset = -1; offset <= 1; ++offset) {
+      int adj_col = prev_col + offset;
+      if (adj_col >= 0 && adj_col < cols && ligne[adj_col] < min_val) {
+        min_val = ligne[adj_col];
+        min_col = adj_col;
+      }
+    }
+
+    way[k] = min_col; // Enregistrer la colonne trouvée
+  }
+} // Fin remonterWayCols
+
+/**
+ * Recherche du chemin minium du bas vers le haut
+ *
+ * @param m_cumul Matrice cumulative adaptée à la suppression de colonnes
+ * @param way Tableau de taille rows qui reçoit l'indice de la colonne à
+ * supprimer sur chaque ligne
+ */
+void findWayCols(const Mat &image, const int *m_cumul, int *way) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  // Étape 1 : Trouver le minimum dans la dernière ligne
+  way[0] = argminSimd(m_cumul + (size_t)(rows - 1) * cols, cols);
+
+  // Étape 2 : Remonter ligne par ligne
+  remonterWayCols(m_cumul, rows, cols, way);
+} // Fin findWayCols
+
+/**
+ * Recherche du chemin minimal à partir de la matrice cumulative compacte
+ * (voir matriceCumulativeColsCompacte) : même chemin que findWayCols.
+ *
+ * @param derniere Dernière ligne de la matrice cumulative
+ * @param directions Directions de remontée de chaque pixel
+ * @param way Tableau de taille rows qui reçoit le chemin
+ */
+void findWayColsCompacte(const Mat &image, const int *derniere,
+                         const unsigned char *directions, int *way) {
+  int rows = image.rows;
+  int cols = image.cols;
+  size_t pas = (cols + DIRECTIONS_PAR_OCTET - 1) / DIRECTIONS_PAR_OCTET;
+
+  way[0] = argminSimd(derniere, cols);
+  for (int i = rows - 1, k = 1; i >= 1; --i, ++k) {
+    int j = way[k - 1];
+    int direction = (directions[i * pas + j / DIRECTIONS_PAR_OCTET] >>
+                     (2 * (j % DIRECTIONS_PAR_OCTET))) &
+                    3;
+    way[k] = j + (direction == DIRECTION_GAUCHE   ? -1
+                  : direction == DIRECTION_DROITE ? 1
+                                                  : 0);
+  }
+} // Fin findWayColsCompacte
+
+/**
+ * Recherche du chemin minimal dans une matrice calculée par
+ * matriceCumulativeColsCouloir : le minimum de la dernière ligne est cherché
+ * dans le couloir, la remontée ne peut pas en sortir.
+ *
+ * @param m_cumul Matrice cumulative restreinte au couloir
+ * @param centre Chemin central du couloir
+ * @param largeur Demi-largeur du couloir
+ * @param way Tableau de taille rows qui reçoit le chemin
+ */
+void findWayColsCouloir(const Mat &image, const int *m_cumul,
+                        const int *centre, int largeur, int *way) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  int c = min(max(centre[0], 0), cols - 1);
+  int debut = max(c - largeur, 0);
+  int fin = min(c + largeur + 1, cols);
+  way[0] = debut + argminSimd(m_cumul + (size_t)(rows - 1) * cols + debut,
+                              fin - debut);
+
+  remonterWayCols(m_cumul, rows, cols, way);
+} // Fin findWayColsCouloir
+
+/**
+ * Crée la matrice cumulative (seam colonnes) d'une suppression d'objet,
+ * limitée aux colonnes [debut, fin) : chaque pixel du masque reçoit l'énergie
+ * -bonus, si bien que le seam minimal passe par le plus de pixels du masque
+ * possible. Une case de chaque côté de la fenêtre reçoit INT_MAX, et le coût
+ * est en O(rows x (fin - debut)).
+ *
+ * @param image Image d'énergie
+ * @param masque Pixels à retirer (non nuls), CV_8UC1 à la taille de image
+ * @param m_cumul Matrice cumulative, au même format que matriceCumulativeCols
+ * @param debut Première colonne de la fenêtre
+ * @param fin Colonne de fin de la fenêtre (exclue)
+ * @param bonus Énergie retirée pour chaque pixel du masque
+ */
+void matriceCumulativeColsMasque(const Mat &image, const Mat &masque,
+                                 int *m_cumul, int debut, int fin, int bonus) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  for (int i = 0; i < rows; ++i) {
+    int *courant = m_cumul + (size_t)i * cols;
+    if (i == 0) {
+      const uchar *energie = image.ptr<uchar>(0);
+      for (int j = debut; j < fin; ++j) {
+        courant[j] = energie[j];
+      }
+    } else {
+      ligneCumulativeSimd(courant - cols, image.ptr<uchar>(i), courant, debut,
+                          fin, cols);
+    }
+
+    const uchar *m = masque.ptr<uchar>(i);
+    for (int j = debut; j < fin; ++j) {
+      if (m[j]) {
+        courant[j] -= bonus;
+      }
+    }
+
+    if (debut > 0) {
+      courant[debut - 1] = INT_MAX;
+    }
+    if (fin < cols) {
+      courant[fin] = INT_MAX;
+    }
+  }
+} // Fin matriceCumulativeColsMasque
+
+/**
+ * Recherche du chemin minimal dans une matrice calculée par
+ * matriceCumulativeColsMasque, sans sortir de la fenêtre.
+ *
+ * @param m_cumul Matrice cumulative restreinte à la fenêtre
+ * @param debut Première colonne de la fenêtre
+ * @param fin Colonne de fin de la fenêtre (exclue)
+ * @param way Tableau de taille rows qui reçoit le chemin
+ */
+void findWayColsMasque(const Mat &image, const int *m_cumul, int debut,
+                       int fin, int *way) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  way[0] = debut + argminSimd(m_cumul + (size_t)(rows - 1) * cols + debut,
+                              fin - debut);
+
+  remonterWayCols(m_cumul, rows, cols, way);
+} // Fin findWayColsMasque
+
+/**
+ * Recherche du chemin minimum de droite vers la gauche
+ *
+ * @param m_cumul Matrice cumulative adaptée à la suppression de lignes
+ * @param way Tableau de taille cols qui reçoit l'indice de la ligne à
+ * supprimer sur chaque colonne
+ */
+void findWayRows(const Mat &image, const int *m_cumul, int *way) {
+  int rows = image.rows;
+  int cols = image.cols;
+
+  // Étape 1 : Trouver le minimum dans la dernière colonne
+  const int *colonne = m_cumul + (size_t)(cols - 1) * rows;
+  int min_row = argminSimd(colonne, rows);
+  int min_val;
+
+  way[0] = min_row;
+
+  // Étape 2 : Revenir colonne par colonne
+  for (int j = cols - 2, k = 1; j >= 0; --j, ++k) {
+    colonne = m_cumul + (size_t)j * rows;
+    int prev_row = way[k - 1];
+    min_row = prev_row; // Par défaut, la ligne actuelle est le minimum
+    min_val = colonne[prev_row];
+
+    // Vérifier les lignes adjacentes
+    for (int offset = -1; offset <= 1; ++offset) {
+      int adj_row = prev_row + offset;
+      if (adj_row >= 0 && adj_row < rows && colonne[adj_row] < min_val) {
+        min_val = colonne[adj_row];
+        min_row = adj_row;
+      }
+    }
+
+    way[k] = min_row; // Enregistrer la ligne trouvée
+  }
+} // Fin findWayRows
+
+/**
+ * Extrait plusieurs seams colonnes disjoints d'une même matrice cumulative.
+ *
+ * Les départs sont pris dans la dernière ligne par coût croissant. Chaque
+ * seam remonte comme dans findWayCols (même ordre de préférence), mais en
+ * évitant les pixels déjà pris par les seams précédents de la passe ; un
+ * seam bloqué sur ses trois voisins est abandonné. Le premier seam est donc
+ * exactement celui de findWayCols, les suivants sont des approximations.
+ *
+ * @param image Image d'énergie
+ * @param m_cumul Matrice cumulative adaptée à la suppression de colonnes
+ * @param ways Reçoit les chemins, seam s dans ways[s * rows ...] (du bas
+ * vers le haut, comme way)
+ * @param nb_seams Nombre de seams voulus
+ * @param pris Carte rows x cols des pixels pris, vide en entrée ; les pixels
+ * des seams retournés y restent marqués
+ * @param energie Reçoit la somme de l'énergie des pixels des seams trouvés
+ * @return Nombre de seams trouvés (au moins 1)
+ */
+int findWaysColsDisjoints(const Mat &image, const int *m_cumul, int *ways,
+                          int nb_seams, unsigned char *pris,
+                          long long &energie) {
+  int rows = image.rows;
+  int cols = image.cols;
+  const int *derniere = m_cumul + (size_t)(rows - 1) * cols;
+
+  // Départs triés par coût, puis par colonne en cas d'égalité
+  vector<int> departs(cols);
+  for (int j = 0; j < cols; ++j) {
+    departs[j] = j;
+  }
+  sort(departs.begin(), departs.end(), [derniere](int a, int b) {
+    return derniere[a] < derniere[b] || (derniere[a] == derniere[b] && a < b);
+  });
+
+  // Un seam abandonné coûte jusqu'à une remontée complète : au-delà de
+  // nb_seams abandons, les départs restants sont presque tous bloqués
+  int trouves = 0;
+  int abandons = 0;
+  energie = 0;
+  for (int d = 0; d < cols && trouves < nb_seams && abandons < nb_seams;
+       ++d) {
+    int *way = ways + (size_t)trouves * rows;
+    int depart = departs[d];
+    if (pris[(size_t)(rows - 1) * cols + depart]) {
+      continue;
+    }
+    way[0] = depart;
+    pris[(size_t)(rows - 1) * cols + depart] = 1;
+
+    int k = 1;
+    for (int i = rows - 2; i >= 0; --i, ++k) {
+      const int *ligne = m_cumul + (size_t)i * cols;
+      const unsigned char *ligne_pris = pris + (size_t)i * cols;
+      int prev_col = way[k - 1];
+      int min_col = -1;
+      int min_val = 0;
+
+      // Centre d'abord, puis gauche et droite, comme findWayCols
+      if (!ligne_pris[prev_col]) {
+        min_col = prev_col;
+        min_val = ligne[prev_col];
+      }
+      for (int offset = -1; offset <= 1; offset += 2) {
+        int adj_col = prev_col + offset;
+        if (adj_col >= 0 && adj_col < cols && !ligne_pris[adj_col] &&
+            (min_col < 0 || ligne[adj_col] < min_val)) {
+          min_val = ligne[adj_col];
+          min_col = adj_col;
+        }
+      }
+      if (min_col < 0) {
+        break; // Seam bloqué
+      }
+
+      way[k] = min_col;
+      pris[(size_t)i * cols + min_col] = 1;
+    }
+
+    if (k < rows) {
+      // Abandon : on libère les pixels déjà marqués par ce seam
+      for (int l = 0; l < k; ++l) {
+        pris[(size_t)(rows - 1 - l) * cols + way[l]] = 0;
+      }
+      ++abandons;
+      continue;
+    }
+
+    for (int l = 0; l < rows; ++l) {
+      energie += image.ptr<uchar>(rows - 1 - l)[way[l]];
+    }
+    ++trouves;
+  }
+
+  return trouves;
+} // Fin findWaysColsDisjoints
+
+/**
+ * Appelle fonction avec un pixel nul du type d'image donné, de type
+ * Vec<Canal, N> : les boucles sur les pixels sont écrites une fois, en
+ * templates, et leur instanciation n'est choisie qu'une fois par appel, à
+ * l'entrée, au lieu d'un test par pixel.
+ *
+ * @param type Type d'image (8 ou 16 bits, 1, 3 ou 4 canaux)
+ * @param fonction Lambda générique, appelée avec le pixel
+ * @return false si le type n'est pas pris en charge
+ */
+template <typename Fonction>
+static bool selonPixel(int type, Fonction &&fonction) {
+  switch (type) {
+  case CV_8UC1:
+    fonction(Vec<uchar, 1>());
+    return true;
+  case CV_8UC3:
+    fonction(Vec3b());
+    return true;
+  case CV_8UC4:
+    fonction(Vec4b());
+    return true;
+  case CV_16UC1:
+    fonction(Vec<ushort, 1>());
+    return true;
+  case CV_16UC3:
+    fonction(Vec3w());
+    return true;
+  case CV_16UC4:
+    fonction(Vec4w());
+    return true;
+  default:
+    return false;
+  }
+} // Fin selonPixel
+
+/**
+ * @param type Type d'une image couleur
+ * @return true si les images de ce type peuvent être carvées (niveaux de
+ * gris, BGR ou BGRA, sur 8 ou 16 bits par canal)
+ */
+bool pixelPrisEnCharge(int type) {
+  return selonPixel(type, [](auto) {});
+} // Fin pixelPrisEnCharge
+
+/**
+ * Couleur des seams tracés : rouge, ou blanc en niveaux de gris, à la
+ * valeur maximale du canal et opaque.
+ *
+ * @return Pixel marqueur
+ */
+template <typename Pixel> static Pixel marqueurSeam() {
+  typedef typename Pixel::value_type Canal;
+  Canal maximum = numeric_limits<Canal>::max();
+  Pixel marqueur;
+  if constexpr (Pixel::channels == 1) {
+    marqueur[0] = maximum;
+  } else {
+    marqueur[2] = maximum;
+    if constexpr (Pixel::channels == 4) {
+      marqueur[3] = maximum;
+    }
+  }
+  return marqueur;
+} // Fin marqueurSeam
+
+/**
+ * Suppression du chemin sur l'image, sur place, pour un type de pixel et un
+ * sens de seam fixés à la compilation.
+ *
+ * L'image n'est pas recopiée : chaque ligne (ou colonne) est compactée dans
+ * le même buffer, puis l'en-tête de l'image est réduit d'une colonne (ou
+ * d'une ligne). Les pixels au-delà de la taille logique ne sont plus lus.
+ * Le chemin doit être dans l'image : rien n'est vérifié pixel par pixel.
+ *
+ * @param image Image réduite sur place
+ * @param way Chemin, en partant de la dernière ligne (ou colonne)
+ */
+template <typename Pixel, int SEAM>
+static void suppressionSeamPixels(Mat &image, const int *way) {
+  int rows = image.rows;
+  int cols = image.cols;
+  if constexpr (SEAM == SEAM_COLS) {
+    // Les lignes sont indépendantes : on les répartit sur les threads, et
+    // chacune est décalée d'un seul memmove
+    tbb::parallel_for(tbb::blocked_range<int>(0, rows, SUPPRESSION_GRAIN),
+                      [&](const tbb::blocked_range<int> &r) {
+                        for (int i = r.begin(); i < r.end(); ++i) {
+                          Pixel *ligne = image.ptr<Pixel>(i);
+                          int col = way[rows - 1 - i];
+                          memmove(ligne + col, ligne + col + 1,
+                                  (cols - 1 - col) * sizeof(Pixel));
+                        }
+                      });
+    image = image(Rect(0, 0, cols - 1, rows));
+  } else {
+    // Décalage vers le haut, colonne par colonne en partant de la dernière
+    size_t pas = image.step;
+    for (int j = cols - 1, k = 0; j >= 0; --j, ++k) {
+      uchar *pixel = image.ptr(way[k]) + j * sizeof(Pixel);
+      for (int r = way[k]; r < rows - 1; ++r, pixel += pas) {
+        memcpy(pixel, pixel + pas, sizeof(Pixel));
+      }
+    }
+    image = image(Rect(0, 0, cols, rows - 1));
+  }
+} // Fin suppressionSeamPixels
+
+/**
+ * Choisit la suppression d'un seam adaptée au type d'une image, une fois
+ * pour toute une boucle de suppression.
+ *
+ * @param type Type de l'image (voir pixelPrisEnCharge)
+ * @param seam_type Type de seam (SEAM_ROWS ou SEAM_COLS)
+ * @return Fonction de suppression, ou nullptr si le type n'est pas pris en
+ * charge
+ */
+SuppressionSeamFn suppressionSeamPour(int type, int seam_type) {
+  SuppressionSeamFn suppression = nullptr;
+  if (seam_type != SEAM_COLS && seam_type != SEAM_ROWS) {
+    return nullptr;
+  }
+  selonPixel(type, [&](auto pixel) {
+    typedef decltype(pixel) Pixel;
+    suppression = (seam_type == SEAM_COLS)
+                      ? suppressionSeamPixels<Pixel, SEAM_COLS>
+                      : suppressionSeamPixels<Pixel, SEAM_ROWS>;
+  });
+  return suppression;
+} // Fin suppressionSeamPour
+
+/**
+ * Suppression du chemin sur l'image en niveaux de gris (ou l'énergie), sur
+ * place (voir suppressionSeamPixels).
+ *
+ * @param image Image en niveaux de gris (CV_8UC1), réduite sur place
+ * @param way Tableau contenant les indices du chemin minimum
+ * @param seam_type Type de seam (SEAM_ROWS ou SEAM_COLS).
+ */
+void suppressionSeamGray(Mat &image, const int *way, int seam_type) {
+  SuppressionSeamFn suppression = suppressionSeamPour(CV_8UC1, seam_type);
+  if (!suppression) {
+    cerr << "Erreur : Type de seam non valide." << endl;
+    return;
+  }
+  suppression(image, way);
+} // fin suppressionSeam
+
+/**
+ * Suppression du chemin sur l'image couleur, sur place (voir
+ * suppressionSeamPixels).
+ *
+ * @param image Image couleur, de tout type pris en charge (voir
+ * pixelPrisEnCharge), réduite sur place
+ * @param way Tableau contenant les indices du chemin minimum
+ * @param seam_type Type de seam (SEAM_ROWS ou SEAM_COLS).
+ */
+void suppressionSeamColor(Mat &image, const int *way, int seam_type) {
+  SuppressionSeamFn suppression = suppressionSeamPour(image.type(), seam_type);
+  if (!suppression) {
+    cerr << "Erreur : Type de seam ou de pixel non valide." << endl;
+    return;
+  }
+  suppression(image, way);
+} // fin suppressionSeamColor
+
+
+/**
+ * Supprime plusieurs seams colonnes disjoints en une seule passe, sur place.
+ *
+ * Chaque ligne est compactée une seule fois : les segments situés entre deux
+ * pixels supprimés sont décalés d'un memmove chacun. La largeur logique est
+ * ensuite réduite du nombre de seams. Fonctionne pour tout type de pixel.
+ *
+ * @param image Image réduite sur place
+ * @param ways Chemins, au format de findWaysColsDisjoints
+ * @param nb_seams Nombre de chemins
+ */
+void suppressionSeamsCols(Mat &image, const int *ways, int nb_seams) {
+  int rows = image.rows;
+  int cols = image.cols;
+  size_t taille_pixel = image.elemSize();
+
+  tbb::parallel_for(
+      tbb::blocked_range<int>(0, rows, SUPPRESSION_GRAIN),
+      [&](const tbb::blocked_range<int> &r) {
+        vector<int> colonnes(nb_seams);
+        for (int i = r.begin(); i < r.end(); ++i) {
+          for (int s = 0; s < nb_seams; ++s) {
+            colonnes[s] = ways[(size_t)s * rows + (rows - 1 - i)];
+          }
+          sort(colonnes.begin(), colonnes.end());
+
+          uchar *ligne = image.ptr(i);
+          int ecrit = colonnes[0];
+          for (int s = 0; s < nb_seams; ++s) {
+            int debut = colonnes[s] + 1;
+            int fin = (s + 1 < nb_seams) ? colonnes[s + 1] : cols;
+            memmove(ligne + ecrit * taille_pixel, ligne + debut * taille_pixel,
+                    (fin - debut) * taille_pixel);
+            ecrit += fin - debut;
+          }
+        }
+      });
+
+  image = image(Rect(0, 0, cols - nb_seams, rows));
+} // Fin suppressionSeamsCols
+
+/**
+ * Supprime un seam colonnes en ne décalant que les pixels situés entre le
+ * seam et la colonne fin : la largeur de l'image ne change pas, et chaque
+ * ligne garde en fin - 1 un pixel mort, à retirer ensuite (voir
+ * retirerColonnes). Fonctionne pour tout type de pixel.
+ *
+ * @param image Image modifiée sur place
+ * @param way Chemin, en partant de la dernière ligne, avant la colonne fin
+ * @param fin Colonne de fin (exclue) de la zone décalée
+ */
+void suppressionSeamColsBornee(Mat &image, const int *way, int fin) {
+  int rows = image.rows;
+  size_t taille_pixel = image.elemSize();
+
+  tbb::parallel_for(tbb::blocked_range<int>(0, rows, SUPPRESSION_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      for (int i = r.begin(); i < r.end(); ++i) {
+                        uchar *ligne = image.ptr(i);
+                        int col = way[rows - 1 - i];
+                        memmove(ligne + col * taille_pixel,
+                                ligne + (col + 1) * taille_pixel,
+                                (fin - 1 - col) * taille_pixel);
+                      }
+                    });
+} // Fin suppressionSeamColsBornee
+
+/**
+ * Retire les colonnes [debut, fin) de chaque ligne, sur place, puis réduit
+ * la largeur logique de l'image d'autant.
+ *
+ * @param image Image réduite sur place
+ * @param debut Première colonne retirée
+ * @param fin Colonne de fin (exclue) des colonnes retirées
+ */
+void retirerColonnes(Mat &image, int debut, int fin) {
+  int rows = image.rows;
+  int cols = image.cols;
+  size_t taille_pixel = image.elemSize();
+  if (debut >= fin) {
+    return;
+  }
+
+  tbb::parallel_for(tbb::blocked_range<int>(0, rows, SUPPRESSION_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      for (int i = r.begin(); i < r.end(); ++i) {
+                        uchar *ligne = image.ptr(i);
+                        memmove(ligne + debut * taille_pixel,
+                                ligne + fin * taille_pixel,
+                                (cols - fin) * taille_pixel);
+                      }
+                    });
+
+  image = image(Rect(0, 0, cols - (fin - debut), rows));
+} // Fin retirerColonnes
+
+/**
+ * Colonne d'origine de chaque pixel, à réduire avec l'image pour retrouver
+ * où se trouvait un pixel supprimé.
+ *
+ * @param rows Nombre de lignes
+ * @param cols Nombre de colonnes
+ * @return Matrice CV_32S avec indices(i, j) = j
+ */
+static Mat indicesOrigine(int rows, int cols) {
+  Mat indices(rows, cols, CV_32S);
+  for (int i = 0; i < rows; ++i) {
+    int *ligne = indices.ptr<int>(i);
+    for (int j = 0; j < cols; ++j) {
+      ligne[j] = j;
+    }
+  }
+  return indices;
+} // Fin indicesOrigine
+
+/**
+ * Note dans la carte d'ordre le tour de suppression des pixels des seams,
+ * puis retire ces pixels de la carte des indices d'origine.
+ *
+ * @param ordre Carte d'ordre, à la taille de l'image d'origine
+ * @param indices Colonnes d'origine, réduites sur place
+ * @param ways Chemins supprimés, au format de findWaysColsDisjoints
+ * @param nb_seams Nombre de chemins
+ * @param tour Tour du premier chemin (les suivants ont les tours suivants)
+ */
+static void noterOrdre(Mat &ordre, Mat &indices, const int *ways, int nb_seams,
+                       int tour) {
+  int rows = indices.rows;
+  for (int s = 0; s < nb_seams; ++s) {
+    const int *way = ways + (size_t)s * rows;
+    for (int l = 0; l < rows; ++l) {
+      int i = rows - 1 - l;
+      ordre.at<int>(i, indices.at<int>(i, way[l])) = tour + s;
+    }
+  }
+  suppressionSeamsCols(indices, ways, nb_seams);
+} // Fin noterOrdre
+
+/**
+ * Enregistre une carte d'ordre de suppression dans un fichier binaire.
+ *
+ * Format : en-tête de six entiers 32 bits (signature INDEX_SIGNATURE,
+ * version, largeur, hauteur, type de seam, taille d'une valeur en octets)
+ * puis la carte ligne par ligne, sur 16 bits si la largeur le permet.
+ *
+ * @param fichier Chemin du fichier
+ * @param ordre Carte d'ordre (CV_32S), dans le sens du carving
+ * @param seam_type Type de seam (SEAM_ROWS ou SEAM_COLS)
+ * @return true si l'écriture a réussi
+ */
+bool sauverIndex(const string &fichier, const Mat &ordre, int seam_type) {
+  FILE *f = fopen(fichier.c_str(), "wb");
+  if (!f) {
+    perror("Erreur d'ouverture du fichier d'index");
+    return false;
+  }
+
+  uint32_t taille = (ordre.cols <= 65536) ? 2 : 4;
+  uint32_t entete[6] = {INDEX_SIGNATURE,      INDEX_VERSION,
+                        (uint32_t)ordre.cols, (uint32_t)ordre.rows,
+                        (uint32_t)seam_type,  taille};
+  bool ok = fwrite(entete, sizeof(entete), 1, f) == 1;
+
+  vector<uint16_t> ligne16(ordre.cols);
+  for (int i = 0; i < ordre.rows && ok; ++i) {
+    const int *ligne = ordre.ptr<int>(i);
+    if (taille == 2) {
+      for (int j = 0; j < ordre.cols; ++j) {
+        ligne16[j] = (uint16_t)ligne[j];
+      }
+      ok = fwrite(ligne16.data(), 2, ordre.cols, f) == (size_t)ordre.cols;
+    } else {
+      ok = fwrite(ligne, 4, ordre.cols, f) == (size_t)ordre.cols;
+    }
+  }
+
+  if (fclose(f) != 0 || !ok) {
+    perror("Erreur d'écriture du fichier d'index");
+    return false;
+  }
+  return true;
+} // Fin sauverIndex
+
+/**
+ * Lit une carte d'ordre de suppression écrite par sauverIndex.
+ *
+ * @param fichier Chemin du fichier
+ * @param seam_type Type de seam attendu (SEAM_ROWS ou SEAM_COLS)
+ * @param taille Taille attendue de la carte (celle de l'image, transposée
+ * pour SEAM_ROWS)
+ * @return Carte d'ordre (CV_32S), vide en cas d'erreur
+ */
+Mat chargerIndex(const string &fichier, int seam_type, Size taille) {
+  FILE *f = fopen(fichier.c_str(), "rb");
+  if (!f) {
+    perror("Erreur d'ouverture du fichier d'index");
+    return Mat();
+  }
+
+  uint32_t entete[6];
+  if (fread(entete, sizeof(entete), 1, f) != 1 ||
+      entete[0] != INDEX_SIGNATURE || entete[1] != INDEX_VERSION ||
+      (entete[5] != 2 && entete[5] != 4) || entete[2] == 0 || entete[3] == 0 ||
+      entete[2] > INT_MAX || entete[3] > INT_MAX) {
+    cerr << "Erreur : Fichier d'index invalide (" << fichier << ")." << endl;
+    fclose(f);
+    return Mat();
+  }
+  if ((int)entete[4] != seam_type) {
+    cerr << "Erreur : Le fichier d'index ne correspond pas au type de seam."
+         << endl;
+    fclose(f);
+    return Mat();
+  }
+
+  int cols = entete[2];
+  int rows = entete[3];
+  if (cols != taille.width || rows != taille.height) {
+    cerr << "Erreur : L'index ne correspond pas à la taille de l'image."
+         << endl;
+    fclose(f);
+    return Mat();
+  }
+  Mat ordre(rows, cols, CV_32S);
+  vector<uint16_t> ligne16(cols);
+  bool ok = true;
+  for (int i = 0; i < rows && ok; ++i) {
+    int *ligne = ordre.ptr<int>(i);
+    if (entete[5] == 2) {
+      ok = fread(ligne16.data(), 2, cols, f) == (size_t)cols;
+      for (int j = 0; j < cols; ++j) {
+        ligne[j] = ligne16[j];
+      }
+    } else {
+      ok = fread(ligne, 4, cols, f) == (size_t)cols;
+    }
+  }
+  fclose(f);
+
+  if (!ok) {
+    cerr << "Erreur : Fichier d'index tronqué (" << fichier << ")." << endl;
+    return Mat();
+  }
+  return ordre;
+} // Fin chargerIndex
+
+/**
+ * Vérifie qu'une carte d'ordre peut servir à redimensionner une image : sur
+ * chaque ligne, chaque tour de 0 à cols - 1 doit apparaître exactement une
+ * fois, sans quoi une ligne perdrait ou gagnerait plus de pixels que prévu.
+ *
+ * @param ordre Carte d'ordre (CV_32S)
+ * @return false si la carte n'est pas une permutation de [0, cols) sur
+ * chaque ligne
+ */
+bool verifierOrdre(const Mat &ordre) {
+  if (ordre.empty() || ordre.type() != CV_32S) {
+    return false;
+  }
+  int cols = ordre.cols;
+  vector<char> lignes_valides(ordre.rows, 1);
+  tbb::parallel_for(tbb::blocked_range<int>(0, ordre.rows, SUPPRESSION_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      vector<char> vu(cols);
+                      for (int i = r.begin(); i < r.end(); ++i) {
+                        fill(vu.begin(), vu.end(), 0);
+                        const int *o = ordre.ptr<int>(i);
+                        for (int j = 0; j < cols; ++j) {
+                          if (o[j] < 0 || o[j] >= cols || vu[o[j]]) {
+                            lignes_valides[i] = 0;
+                            break;
+                          }
+                          vu[o[j]] = 1;
+                        }
+                      }
+                    });
+  return find(lignes_valides.begin(), lignes_valides.end(), 0) ==
+         lignes_valides.end();
+} // Fin verifierOrdre
+
+/**
+ * Réduit une image de NB_TOUR colonnes à partir de sa carte d'ordre, en une
+ * seule passe : on garde les pixels supprimés au tour NB_TOUR ou après.
+ * Le résultat est celui des NB_TOUR premiers seams du carving.
+ *
+ * @param image Image d'origine, de tout type pris en charge, dans le sens du
+ * carving
+ * @param ordre Carte d'ordre de l'image
+ * @param NB_TOUR Nombre de seams à retirer
+ * @return Image réduite, vide si le type n'est pas pris en charge
+ */
+Mat redimensionnerIndex(const Mat &image, const Mat &ordre, int NB_TOUR) {
+  Mat resultat(image.rows, image.cols - NB_TOUR, image.type());
+
+  bool valide = selonPixel(image.type(), [&](auto pixel) {
+    typedef decltype(pixel) Pixel;
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, image.rows, SUPPRESSION_GRAIN),
+        [&](const tbb::blocked_range<int> &r) {
+          for (int i = r.begin(); i < r.end(); ++i) {
+            const Pixel *source = image.ptr<Pixel>(i);
+            const int *o = ordre.ptr<int>(i);
+            Pixel *sortie = resultat.ptr<Pixel>(i);
+            for (int j = 0; j < image.cols; ++j) {
+              if (o[j] >= NB_TOUR) {
+                *sortie++ = source[j];
+              }
+            }
+          }
+        });
+  });
+  if (!valide) {
+    cerr << "Erreur : Type de pixel non pris en charge." << endl;
+    return Mat();
+  }
+
+  return resultat;
+} // Fin redimensionnerIndex
+
+/**
+ * Élargit une image de nb_seams colonnes à partir de sa carte d'ordre : les
+ * pixels des nb_seams premiers seams sont dédoublés, chacun remplacé par la
+ * moyenne avec son voisin de gauche puis par la moyenne avec son voisin de
+ * droite. Tout est écrit en une seule passe dans l'image de sortie, allouée
+ * une fois à sa taille finale.
+ *
+ * @param image Image d'origine, de tout type pris en charge, dans le sens du
+ * carving
+ * @param ordre Carte d'ordre de l'image
+ * @param nb_seams Nombre de seams à insérer
+ * @return Image élargie, vide si le type n'est pas pris en charge
+ */
+Mat agrandirIndex(const Mat &image, const Mat &ordre, int nb_seams) {
+  Mat resultat(image.rows, image.cols + nb_seams, image.type());
+  int cols = image.cols;
+
+  bool valide = selonPixel(image.type(), [&](auto pixel) {
+    typedef decltype(pixel) Pixel;
+    typedef typename Pixel::value_type Canal;
+    const int canaux = Pixel::channels;
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, image.rows, SUPPRESSION_GRAIN),
+        [&](const tbb::blocked_range<int> &r) {
+          for (int i = r.begin(); i < r.end(); ++i) {
+            const Pixel *source = image.ptr<Pixel>(i);
+            const int *o = ordre.ptr<int>(i);
+            Pixel *sortie = resultat.ptr<Pixel>(i);
+            for (int j = 0; j < cols; ++j) {
+              const Pixel &milieu = source[j];
+              if (o[j] >= nb_seams) {
+                *sortie++ = milieu;
+                continue;
+              }
+
+              const Pixel &gauche = (j > 0) ? source[j - 1] : milieu;
+              const Pixel &droite = (j < cols - 1) ? source[j + 1] : milieu;
+              for (int c = 0; c < canaux; ++c) {
+                sortie[0][c] = (Canal)((gauche[c] + milieu[c] + 1) / 2);
+                sortie[1][c] = (Canal)((milieu[c] + droite[c] + 1) / 2);
+              }
+              sortie += 2;
+            }
+          }
+        });
+  });
+  if (!valide) {
+    cerr << "Erreur : Type de pixel non pris en charge." << endl;
+    return Mat();
+  }
+
+  return resultat;
+} // Fin agrandirIndex
+
+/**
+ * Trace en rouge (en blanc en niveaux de gris), sur l'image d'origine, les
+ * NB_TOUR premiers seams lus dans la carte d'ordre.
+ *
+ * @param image Image d'origine, de tout type pris en charge, dans le sens du
+ * carving
+ * @param ordre Carte d'ordre de l'image
+ * @param NB_TOUR Nombre de seams à tracer
+ * @return Image avec les seams tracés
+ */
+Mat seamsIndex(const Mat &image, const Mat &ordre, int NB_TOUR) {
+  Mat seamed_img = image.clone();
+
+  bool valide = selonPixel(image.type(), [&](auto pixel) {
+    typedef decltype(pixel) Pixel;
+    Pixel marqueur = marqueurSeam<Pixel>();
+    tbb::parallel_for(
+        tbb::blocked_range<int>(0, image.rows, SUPPRESSION_GRAIN),
+        [&](const tbb::blocked_range<int> &r) {
+          for (int i = r.begin(); i < r.end(); ++i) {
+            const int *o = ordre.ptr<int>(i);
+            Pixel *ligne = seamed_img.ptr<Pixel>(i);
+            for (int j = 0; j < image.cols; ++j) {
+              if (o[j] < NB_TOUR) {
+                ligne[j] = marqueur;
+              }
+            }
+          }
+        });
+  });
+  if (!valide) {
+    cerr << "Erreur : Type de pixel non pris en charge." << endl;
+  }
+
+  return seamed_img;
+} // Fin seamsIndex
+
+/**
+ * Boucle de suppression des seams colonnes, sur place.
+ *
+ * Les seams lignes passent aussi par cette boucle, sur des copies transposées
+ * des images : les accès restent ainsi ligne par ligne, contigus en mémoire.
+ *
+ * @param image_reduce Image couleur, réduite sur place
+ * @param image_gradient Énergie de l'image, réduite sur place
+ * @param img_seamed Image couleur d'origine, sur laquelle les seams sont
+ * tracés une fois à la fin, à leur place d'origine, ou nullptr
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param ws Espace de travail alloué pour la taille des images
+ * @param locale Énergie locale tenue à jour après chaque seam, ou nullptr
+ * pour seulement décaler l'énergie
+ * @param ordre Reçoit le tour de suppression de chaque pixel (CV_32S, à la
+ * taille de l'image), ou nullptr
+ * @param options Options du seam carving
+ * @return Bilan de la suppression
  */
-int **matriceCumulativeCols(const Mat &image) {
-  int rows = image.rows;
-  int cols = image.cols;
-
-  // Allocation de la matrice cumulative
-  int **m_cumul = (int **)malloc(rows * sizeof(int *));
-  if (!m_cumul) {
-    perror("Erreur d'allocation mémoire pour la matrice cumulative");
-    return nullptr;
+BilanSeams boucleSeamsCols(Mat &image_reduce, Mat &image_gradient,
+                           Mat *img_seamed, int NB_TOUR, SeamWorkspace &ws,
+                           EnergieLocale *locale, Mat *ordre,
+                           const SeamOptions &options) {
+  BilanSeams bilan;
+
+  // Chaque seam est noté dans la carte d'ordre, via la colonne d'origine de
+  // chaque pixel, et les seams sont tracés d'un coup à la fin
+  Mat ordre_seamed;
+  if (img_seamed && !ordre) {
+    ordre_seamed = Mat(image_gradient.size(), CV_32S, Scalar(NB_TOUR));
+    ordre = &ordre_seamed;
   }
-  for (int i = 0; i < rows; ++i) {
-    m_cumul[i] = (int *)malloc(cols * sizeof(int));
-    if (!m_cumul[i]) {
-      perror("Erreur d'allocation mémoire pour une ligne");
-      for (int k = 0; k < i; ++k)
-        free(m_cumul[k]);
-      free(m_cumul);
-      return nullptr;
-    }
+  Mat indices;
+  if (ordre) {
+    indices = indicesOrigine(image_gradient.rows, image_gradient.cols);
   }
 
-  // Initialisation de la première ligne
-  for (int j = 0; j < cols; ++j) {
-    m_cumul[0][j] = image.at<uchar>(0, j);
+  // Suppressions choisies une fois pour toutes selon le type des images
+  SuppressionSeamFn supprimer_energie = suppressionSeamPour(CV_8UC1, SEAM_COLS);
+  SuppressionSeamFn supprimer_couleur =
+      image_reduce.empty() ? nullptr
+                           : suppressionSeamPour(image_reduce.type(), SEAM_COLS);
+  if (!image_reduce.empty() && !supprimer_couleur) {
+    cerr << "Erreur : Type de pixel non pris en charge." << endl;
+    return bilan;
   }
 
-  // Calcul de la matrice cumulative
-  for (int i = 1; i < rows; ++i) {
-    for (int j = 0; j < cols; ++j) {
-      int current_pixel = image.at<uchar>(i, j);
-      int min_prev = m_cumul[i - 1][j];
-
-      // Vérifier les pixels voisins en respectant les limites
-      if (j > 0) {
-        min_prev = min(min_prev, m_cumul[i - 1][j - 1]);
+  // Avec l'énergie locale, les valeurs modifiées autour du seam se propagent
+  // dans toute la suite de la matrice : la mise à jour incrémentale ne se
+  // resserre plus et la reconstruction parallèle est plus rapide
+  bool incremental = options.incremental && !locale;
+  for (int tour = 0; tour < NB_TOUR; ++tour) {
+    // Calcul de la matrice cumulative et du chemin minimal. En mode compact,
+    // la matrice ne garde que sa dernière ligne, en tête de ws.m_cumul.
+    const int *derniere;
+    if (options.dp_compact) {
+      {
+        PROFIL_ETAPE("matrice");
+        matriceCumulativeColsCompacte(image_gradient, ws.m_cumul,
+                                      ws.directions);
       }
-      if (j < cols - 1) {
-        min_prev = min(min_prev, m_cumul[i - 1][j + 1]);
+      PROFIL_ETAPE("chemin");
+      findWayColsCompacte(image_gradient, ws.m_cumul, ws.directions, ws.way);
+      derniere = ws.m_cumul;
+    } else {
+      {
+        PROFIL_ETAPE("matrice");
+        if (tour > 0 && incremental) {
+          majMatriceCumulativeCols(image_gradient, ws.m_cumul, ws.way);
+        } else {
+          matriceCumulativeCols(image_gradient, ws.m_cumul);
+        }
       }
-
-      m_cumul[i][j] = current_pixel + min_prev;
+      PROFIL_ETAPE("chemin");
+      findWayCols(image_gradient, ws.m_cumul, ws.way);
+      derniere =
+          ws.m_cumul + (size_t)(image_gradient.rows - 1) * image_gradient.cols;
+    }
+    bilan.energie += derniere[ws.way[0]];
+    ++bilan.passes;
+
+    // Suppression du chemin dans les différentes images (l'image couleur
+    // peut être absente si seul l'ordre de suppression est voulu)
+    {
+      PROFIL_ETAPE("suppression");
+      supprimer_energie(image_gradient, ws.way);
+      if (supprimer_couleur) {
+        supprimer_couleur(image_reduce, ws.way);
+      }
+    }
+    if (locale) {
+      PROFIL_ETAPE("energie locale");
+      majEnergieLocale(*locale, image_gradient, ws.way, 1);
+    }
+    if (ordre) {
+      PROFIL_ETAPE("ordre");
+      noterOrdre(*ordre, indices, ws.way, 1, tour);
     }
   }
-
-  return m_cumul;
-} // Fin matriceCumulativeCols
+  if (img_seamed) {
+    PROFIL_ETAPE("imageSeamed");
+    *img_seamed = seamsIndex(*img_seamed, *ordre, NB_TOUR);
+  }
+  return bilan;
+} // Fin boucleSeamsCols
 
 /**
- * Crée la matrice cumulative en partant de gauche vers la droite.
- * Adapté à un seam ligne.
+ * Boucle de suppression des seams colonnes par lots : chaque matrice
+ * cumulative fournit jusqu'à options.seams_par_passe seams disjoints, retirés
+ * ensemble en une seule compaction. La matrice est reconstruite à chaque
+ * passe (la mise à jour incrémentale ne suit qu'un seam).
  *
- * @param image Image d'entrée
- * @return Matrice cumulative
+ * @param image_reduce Image couleur, réduite sur place
+ * @param image_gradient Énergie de l'image, réduite sur place
+ * @param img_seamed Image couleur d'origine, sur laquelle les seams sont
+ * tracés une fois à la fin, à leur place d'origine, ou nullptr
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param ws Espace de travail alloué pour options.seams_par_passe chemins
+ * @param locale Énergie locale tenue à jour après chaque passe, ou nullptr
+ * pour seulement décaler l'énergie
+ * @param ordre Reçoit le tour de suppression de chaque pixel (CV_32S, à la
+ * taille de l'image), ou nullptr
+ * @param options Options du seam carving
+ * @return Bilan de la suppression
  */
-int **matriceCumulativeRows(const Mat &image) {
-  int rows = image.rows;
-  int cols = image.cols;
-
-  // Allocation de la matrice cumulative
-  int **m_cumul = (int **)malloc(rows * sizeof(int *));
-  if (!m_cumul) {
-    perror("Erreur d'allocation mémoire pour la matrice cumulative");
-    return nullptr;
+BilanSeams boucleSeamsColsParLots(Mat &image_reduce, Mat &image_gradient,
+                                  Mat *img_seamed, int NB_TOUR,
+                                  SeamWorkspace &ws, EnergieLocale *locale,
+                                  Mat *ordre, const SeamOptions &options) {
+  BilanSeams bilan;
+
+  // Chaque seam est noté dans la carte d'ordre, via la colonne d'origine de
+  // chaque pixel, et les seams sont tracés d'un coup à la fin
+  Mat ordre_seamed;
+  if (img_seamed && !ordre) {
+    ordre_seamed = Mat(image_gradient.size(), CV_32S, Scalar(NB_TOUR));
+    ordre = &ordre_seamed;
   }
-  for (int i = 0; i < rows; ++i) {
-    m_cumul[i] = (int *)malloc(cols * sizeof(int));
-    if (!m_cumul[i]) {
-      perror("Erreur d'allocation mémoire pour une ligne");
-      for (int k = 0; k < i; ++k)
-        free(m_cumul[k]);
-      free(m_cumul);
-      return nullptr;
+  Mat indices;
+  if (ordre) {
+    indices = indicesOrigine(image_gradient.rows, image_gradient.cols);
+  }
+  int restants = NB_TOUR;
+  while (restants > 0) {
+    int rows = image_gradient.rows;
+    int cols = image_gradient.cols;
+    int voulus = min(options.seams_par_passe, restants);
+
+    {
+      PROFIL_ETAPE("matrice");
+      matriceCumulativeCols(image_gradient, ws.m_cumul);
+    }
+    long long energie;
+    int trouves;
+    {
+      PROFIL_ETAPE("chemin");
+      trouves = findWaysColsDisjoints(image_gradient, ws.m_cumul, ws.way,
+                                      voulus, ws.pris, energie);
+    }
+    bilan.energie += energie;
+    ++bilan.passes;
+
+    // La carte des pixels pris est remise à zéro avant que la largeur change
+    for (int s = 0; s < trouves; ++s) {
+      const int *way = ws.way + (size_t)s * rows;
+      for (int l = 0; l < rows; ++l) {
+        ws.pris[(size_t)(rows - 1 - l) * cols + way[l]] = 0;
+      }
+    }
+
+    {
+      PROFIL_ETAPE("suppression");
+      suppressionSeamsCols(image_gradient, ws.way, trouves);
+      if (!image_reduce.empty()) {
+        suppressionSeamsCols(image_reduce, ws.way, trouves);
+      }
+    }
+    if (locale) {
+      PROFIL_ETAPE("energie locale");
+      majEnergieLocale(*locale, image_gradient, ws.way, trouves);
     }
+    if (ordre) {
+      PROFIL_ETAPE("ordre");
+      noterOrdre(*ordre, indices, ws.way, trouves, NB_TOUR - restants);
+    }
+    restants -= trouves;
+  }
+  if (img_seamed) {
+    PROFIL_ETAPE("imageSeamed");
+    *img_seamed = seamsIndex(*img_seamed, *ordre, NB_TOUR);
   }
+  return bilan;
+} // Fin boucleSeamsColsParLots
 
-  // Initialisation de la première colonne
-  for (int i = 0; i < rows; ++i) {
-    m_cumul[i][0] = image.at<uchar>(i, 0);
+/**
+ * Découpe l'image en tranches verticales pour boucleSeamsColsTranches.
+ *
+ * Chaque coupure part de sa position régulière et glisse, d'au plus une
+ * fraction 1 / TRANCHE_MARGE de la largeur d'une tranche, jusqu'à la colonne
+ * d'énergie totale la plus forte : les seams, qui ne peuvent pas franchir
+ * une coupure, s'en seraient écartés de toute façon.
+ *
+ * @param energie Énergie de l'image
+ * @param nb_tranches Nombre de tranches
+ * @return Bornes des tranches (nb_tranches + 1 colonnes, de 0 à cols)
+ */
+static vector<int> decouperTranches(const Mat &energie, int nb_tranches) {
+  int rows = energie.rows;
+  int cols = energie.cols;
+  vector<int> bornes(nb_tranches + 1);
+  bornes[0] = 0;
+  bornes[nb_tranches] = cols;
+
+  // Énergie totale de chaque colonne, par blocs de colonnes
+  vector<long long> sommes(cols, 0);
+  tbb::parallel_for(tbb::blocked_range<int>(0, cols, DP_TUILE),
+                    [&](const tbb::blocked_range<int> &r) {
+                      for (int i = 0; i < rows; ++i) {
+                        const uchar *e = energie.ptr<uchar>(i);
+                        for (int j = r.begin(); j < r.end(); ++j) {
+                          sommes[j] += e[j];
+                        }
+                      }
+                    });
+
+  int marge = cols / (nb_tranches * TRANCHE_MARGE);
+  for (int t = 1; t < nb_tranches; ++t) {
+    int regulier = (int)((long long)t * cols / nb_tranches);
+    int coupure = regulier;
+    for (int j = regulier - marge; j <= regulier + marge; ++j) {
+      if (sommes[j] > sommes[coupure]) {
+        coupure = j;
+      }
+    }
+    bornes[t] = coupure;
   }
+  return bornes;
+} // Fin decouperTranches
 
-  // Calcul de la matrice cumulative
-  for (int j = 1; j < cols; ++j) {
-    for (int i = 0; i < rows; ++i) {
-      int current_pixel = image.at<uchar>(i, j);
-      int min_prev = m_cumul[i][j - 1];
+/**
+ * Répartit les seams entre les tranches selon leur énergie.
+ *
+ * Sur chaque ligne, les NB_TOUR pixels de plus faible énergie sont ceux
+ * qu'un carving exact aurait tendance à retirer : chaque tranche reçoit la
+ * part moyenne de ces pixels qu'elle contient (les pixels au seuil sont
+ * partagés au prorata), arrondie au plus fort reste. Une tranche garde au
+ * moins une colonne ; ce qu'elle ne peut pas prendre va aux autres.
+ *
+ * @param energie Énergie de l'image (CV_8U)
+ * @param bornes Bornes des tranches (voir decouperTranches)
+ * @param NB_TOUR Nombre de seams à retirer, au plus cols - nombre de tranches
+ * @return Nombre de seams de chaque tranche
+ */
+static vector<int> repartirSeams(const Mat &energie, const vector<int> &bornes,
+                                 int NB_TOUR) {
+  int rows = energie.rows;
+  int nb_tranches = (int)bornes.size() - 1;
+
+  // Part de chaque tranche, ligne par ligne
+  Mat parts(rows, nb_tranches, CV_64F);
+  tbb::parallel_for(
+      tbb::blocked_range<int>(0, rows, ENERGIE_GRAIN),
+      [&](const tbb::blocked_range<int> &r) {
+        int histogramme[256];
+        for (int i = r.begin(); i < r.end(); ++i) {
+          const uchar *e = energie.ptr<uchar>(i);
+          memset(histogramme, 0, sizeof(histogramme));
+          for (int j = 0; j < energie.cols; ++j) {
+            ++histogramme[e[j]];
+          }
+          int seuil = 0;
+          int dessous = 0;
+          while (dessous + histogramme[seuil] < NB_TOUR) {
+            dessous += histogramme[seuil++];
+          }
+          double prorata =
+              (double)(NB_TOUR - dessous) / max(histogramme[seuil], 1);
+
+          double *p = parts.ptr<double>(i);
+          for (int t = 0; t < nb_tranches; ++t) {
+            int sous_seuil = 0;
+            int au_seuil = 0;
+            for (int j = bornes[t]; j < bornes[t + 1]; ++j) {
+              sous_seuil += e[j] < seuil;
+              au_seuil += e[j] == seuil;
+            }
+            p[t] = sous_seuil + au_seuil * prorata;
+          }
+        }
+      });
 
-      // Vérifier les pixels voisins en respectant les limites
-      if (i > 0) {
-        min_prev = min(min_prev, m_cumul[i - 1][j - 1]);
-      }
-      if (i < rows - 1) {
-        min_prev = min(min_prev, m_cumul[i + 1][j - 1]);
+  // Moyenne sur les lignes, arrondie au plus fort reste
+  vector<double> attendus(nb_tranches, 0);
+  for (int i = 0; i < rows; ++i) {
+    const double *p = parts.ptr<double>(i);
+    for (int t = 0; t < nb_tranches; ++t) {
+      attendus[t] += p[t];
+    }
+  }
+  vector<int> seams(nb_tranches);
+  int restants = NB_TOUR;
+  for (int t = 0; t < nb_tranches; ++t) {
+    attendus[t] /= rows;
+    seams[t] = min((int)attendus[t], bornes[t + 1] - bornes[t] - 1);
+    restants -= seams[t];
+  }
+  while (restants > 0) {
+    int choix = -1;
+    for (int t = 0; t < nb_tranches; ++t) {
+      if (seams[t] < bornes[t + 1] - bornes[t] - 1 &&
+          (choix < 0 ||
+           attendus[t] - seams[t] > attendus[choix] - seams[choix])) {
+        choix = t;
       }
-
-      m_cumul[i][j] = current_pixel + min_prev;
     }
+    ++seams[choix];
+    --restants;
   }
-
-  return m_cumul;
-} // Fin matriceCumulativeRows
+  return seams;
+} // Fin repartirSeams
 
 /**
- * Recherche du chemin minium du bas vers le haut
+ * Recolle, ligne par ligne, les tranches d'une image carvées séparément :
+ * la tranche t, réduite à gauche de sa zone, est ramenée juste après la
+ * tranche t - 1. L'image est ensuite réduite de tous les seams retirés.
  *
- * @param m_cumul Matrice cumulative adaptée à la suppression de colonnes
- * @return Tableau de taille rows qui contient l'indice de la colonne à
- * supprimer sur chaque ligne
+ * @param image Image dont les tranches ont été réduites sur place
+ * @param bornes Bornes des tranches avant suppression
+ * @param seams Nombre de seams retirés de chaque tranche
  */
-int *findWayCols(const Mat &image, int **m_cumul) {
-  int rows = image.rows;
-  int cols = image.cols;
+static void assemblerTranches(Mat &image, const vector<int> &bornes,
+                              const vector<int> &seams) {
+  int nb_tranches = (int)seams.size();
+  size_t taille = image.elemSize();
+  int largeur = 0;
+  for (int t = 0; t < nb_tranches; ++t) {
+    largeur += bornes[t + 1] - bornes[t] - seams[t];
+  }
+  tbb::parallel_for(tbb::blocked_range<int>(0, image.rows, SUPPRESSION_GRAIN),
+                    [&](const tbb::blocked_range<int> &r) {
+                      for (int i = r.begin(); i < r.end(); ++i) {
+                        uchar *ligne = image.ptr(i);
+                        size_t position = 0;
+                        for (int t = 0; t < nb_tranches; ++t) {
+                          size_t gardes =
+                              (bornes[t + 1] - bornes[t] - seams[t]) * taille;
+                          memmove(ligne + position, ligne + bornes[t] * taille,
+                                  gardes);
+                          position += gardes;
+                        }
+                      }
+                    });
+  image = image(Rect(0, 0, largeur, image.rows));
+} // Fin assemblerTranches
 
-  // Tableau pour stocker le chemin
-  int *way = (int *)malloc(sizeof(int) * rows);
-  if (!way) {
-    perror("Erreur d'allocation mémoire");
-    return nullptr;
+/**
+ * Boucle de suppression approchée des seams colonnes, par tranches
+ * verticales carvées en parallèle.
+ *
+ * L'image est découpée en nb_tranches tranches (voir decouperTranches) et
+ * les seams répartis entre elles selon leur énergie (voir repartirSeams).
+ * Chaque tranche est ensuite carvée seam par seam, sur sa propre tâche et
+ * avec son propre espace de travail, sans qu'aucun seam ne franchisse une
+ * coupure : chaque ligne perd autant de pixels dans une tranche, et les
+ * tranches se recollent ligne par ligne. L'énergie est celle de l'image
+ * entière, les bords des tranches ne sont donc pas favorisés. La mise à
+ * jour incrémentale de la matrice cumulative reste bornée par la largeur de
+ * la tranche, ce qui fait l'essentiel du gain sur les grandes réductions.
+ *
+ * @param image_reduce Image couleur, réduite sur place
+ * @param image_gradient Énergie de l'image, réduite sur place
+ * @param img_seamed Image couleur d'origine, sur laquelle les pixels retirés
+ * sont tracés, ou nullptr
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param nb_tranches Nombre de tranches, ramené au besoin à cols - NB_TOUR
+ * pour que chaque tranche garde une colonne
+ * @param options Options du seam carving (incremental, dp_compact)
+ * @return Bilan de la suppression (passes nul en cas d'erreur)
+ */
+BilanSeams boucleSeamsColsTranches(Mat &image_reduce, Mat &image_gradient,
+                                   Mat *img_seamed, int NB_TOUR,
+                                   int nb_tranches,
+                                   const SeamOptions &options) {
+  BilanSeams bilan;
+  int rows = image_gradient.rows;
+  int cols = image_gradient.cols;
+  nb_tranches = max(1, min(nb_tranches, cols - NB_TOUR));
+  bilan.tranches = nb_tranches;
+
+  vector<int> bornes, seams;
+  {
+    PROFIL_ETAPE("tranches");
+    bornes = decouperTranches(image_gradient, nb_tranches);
+    seams = repartirSeams(image_gradient, bornes, NB_TOUR);
   }
 
-  // Étape 1 : Trouver le minimum dans la dernière ligne
-  int min_col = 0;
-  int min_val = INT_MAX;
+  // Les pixels jamais retirés gardent l'ordre NB_TOUR
+  Mat ordre;
+  if (img_seamed) {
+    ordre = Mat(rows, cols, CV_32S, Scalar(NB_TOUR));
+  }
 
-  for (int j = 0; j < cols; ++j) {
-    if (m_cumul[rows - 1][j] < min_val) {
-      min_val = m_cumul[rows - 1][j];
-      min_col = j;
+  vector<BilanSeams> bilans(nb_tranches);
+  vector<char> echecs(nb_tranches, 0);
+  tbb::parallel_for(
+      tbb::blocked_range<int>(0, nb_tranches, 1),
+      [&](const tbb::blocked_range<int> &r) {
+        for (int t = r.begin(); t < r.end(); ++t) {
+          SeamWorkspace ws;
+          int debut = bornes[t];
+          int fin = bornes[t + 1];
+          if (!allouerWorkspace(ws, rows, fin - debut, 1,
+                                options.dp_compact)) {
+            echecs[t] = 1;
+            continue;
+          }
+          Mat couleur;
+          if (!image_reduce.empty()) {
+            couleur = image_reduce.colRange(debut, fin);
+          }
+          Mat energie = image_gradient.colRange(debut, fin);
+          Mat ordre_tranche;
+          if (img_seamed) {
+            ordre_tranche = ordre.colRange(debut, fin);
+          }
+          bilans[t] = boucleSeamsCols(couleur, energie, nullptr, seams[t], ws,
+                                      nullptr,
+                                      img_seamed ? &ordre_tranche : nullptr,
+                                      options);
+          libererWorkspace(ws);
+        }
+      });
+  for (int t = 0; t < nb_tranches; ++t) {
+    if (echecs[t]) {
+      bilan.passes = 0;
+      return bilan;
     }
+    bilan.energie += bilans[t].energie;
+    bilan.passes += bilans[t].passes;
   }
 
-  way[0] = min_col;
-
-  // Étape 2 : Remonter ligne par ligne
-  for (int i = rows - 2, k = 1; i >= 0; --i, ++k) {
-    int prev_col = way[k - 1];
-    min_col = prev_col; // Par défaut, la colonne actuelle est le minimum
-    min_val = m_cumul[i][prev_col];
-
-    // Vérifier les colonnes adjacentes
-    for (int offset = -1; offset <= 1; ++offset) {
-      int adj_col = prev_col + offset;
-      if (adj_col >= 0 && adj_col < cols && m_cumul[i][adj_col] < min_val) {
-        min_val = m_cumul[i][adj_col];
-        min_col = adj_col;
-      }
+  {
+    PROFIL_ETAPE("assemblage");
+    assemblerTranches(image_gradient, bornes, seams);
+    if (!image_reduce.empty()) {
+      assemblerTranches(image_reduce, bornes, seams);
     }
-
-    way[k] = min_col; // Enregistrer la colonne trouvée
   }
-
-  return way;
-} // Fin findWayCols
+  if (img_seamed) {
+    PROFIL_ETAPE("imageSeamed");
+    *img_seamed = seamsIndex(*img_seamed, ordre, NB_TOUR);
+  }
+  return bilan;
+} // Fin boucleSeamsColsTranches
 
 /**
- * Recherche du chemin minimum de droite vers la gauche
+ * Projette un chemin trouvé sur un niveau grossier de la pyramide sur le
+ * niveau deux fois plus fin, pour servir de centre à un couloir.
  *
- * @param m_cumul Matrice cumulative adaptée à la suppression de lignes
- * @return Tableau de taille cols qui contient l'indice de la ligne à supprimer
- * sur chaque colonne
+ * Chaque ligne fine prend la colonne de la ligne grossière qui la couvre,
+ * mise à l'échelle des largeurs actuelles (les niveaux ne perdent pas leurs
+ * colonnes au même rythme). Le chemin est ensuite resserré pour ne se
+ * décaler que d'une colonne par ligne, comme l'exige
+ * matriceCumulativeColsCouloir.
+ *
+ * @param grossier Chemin du niveau grossier (du bas vers le haut)
+ * @param rows_grossier Nombre de lignes du niveau grossier
+ * @param cols_grossier Nombre de colonnes du niveau grossier
+ * @param centre Reçoit le chemin projeté (du bas vers le haut)
+ * @param rows Nombre de lignes du niveau fin
+ * @param cols Nombre de colonnes du niveau fin
  */
-int *findWayRows(const Mat &image, int **m_cumul) {
-  int rows = image.rows;
-  int cols = image.cols;
+static void projeterChemin(const int *grossier, int rows_grossier,
+                           int cols_grossier, int *centre, int rows,
+                           int cols) {
+  double echelle = (double)cols / cols_grossier;
+  for (int l = 0; l < rows; ++l) {
+    int i = rows - 1 - l;
+    int ig = min((int)((long long)i * rows_grossier / rows), rows_grossier - 1);
+    int c = (int)((grossier[rows_grossier - 1 - ig] + 0.5) * echelle);
+    c = min(max(c, 0), cols - 1);
+    if (l > 0) {
+      c = min(max(c, centre[l - 1] - 1), centre[l - 1] + 1);
+    }
+    centre[l] = c;
+  }
+} // Fin projeterChemin
 
-  // Tableau pour stocker le chemin
-  int *way = (int *)malloc(sizeof(int) * cols);
-  if (!way) {
-    perror("Erreur d'allocation mémoire");
-    return nullptr;
+/**
+ * Boucle de suppression approchée des seams colonnes, du grossier au fin.
+ *
+ * L'énergie est réduite de moitié options.pyramide fois (INTER_AREA). Pour
+ * chaque seam, le chemin minimal est cherché par une matrice cumulative
+ * complète sur le niveau le plus grossier, puis projeté sur chaque niveau
+ * plus fin et affiné dans un couloir de options.largeur_couloir colonnes de
+ * part et d'autre (voir matriceCumulativeColsCouloir) : le coût d'un seam
+ * est celui du niveau grossier plus O(rows x largeur) par niveau. Le niveau
+ * k perd son propre chemin tous les 2^k seams, pour suivre l'image sans
+ * être recalculé. Un niveau devenu plus étroit que PYRAMIDE_LARGEUR_MIN est
+ * abandonné ; sans niveau grossier, chaque seam est cherché exactement.
+ *
+ * @param image_reduce Image couleur, réduite sur place
+ * @param image_gradient Énergie de l'image, réduite sur place
+ * @param img_seamed Image couleur d'origine, sur laquelle les seams sont
+ * tracés une fois à la fin, à leur place d'origine, ou nullptr
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param ws Espace de travail alloué pour la taille des images
+ * @param locale Énergie locale tenue à jour après chaque seam, ou nullptr
+ * pour seulement décaler l'énergie
+ * @param ordre Reçoit le tour de suppression de chaque pixel (CV_32S, à la
+ * taille de l'image), ou nullptr
+ * @param options Options du seam carving (pyramide, largeur_couloir)
+ * @return Bilan de la suppression
+ */
+BilanSeams boucleSeamsColsPyramide(Mat &image_reduce, Mat &image_gradient,
+                                   Mat *img_seamed, int NB_TOUR,
+                                   SeamWorkspace &ws, EnergieLocale *locale,
+                                   Mat *ordre, const SeamOptions &options) {
+  BilanSeams bilan;
+  int rows = image_gradient.rows;
+  int largeur = max(options.largeur_couloir, 1);
+
+  // Chaque seam est noté dans la carte d'ordre, via la colonne d'origine de
+  // chaque pixel, et les seams sont tracés d'un coup à la fin
+  Mat ordre_seamed;
+  if (img_seamed && !ordre) {
+    ordre_seamed = Mat(image_gradient.size(), CV_32S, Scalar(NB_TOUR));
+    ordre = &ordre_seamed;
+  }
+  Mat indices;
+  if (ordre) {
+    indices = indicesOrigine(image_gradient.rows, image_gradient.cols);
   }
 
-  // Étape 1 : Trouver le minimum dans la dernière colonne
-  int min_row = 0;
-  int min_val = INT_MAX;
+  SuppressionSeamFn supprimer_energie = suppressionSeamPour(CV_8UC1, SEAM_COLS);
+  SuppressionSeamFn supprimer_couleur =
+      image_reduce.empty()
+          ? nullptr
+          : suppressionSeamPour(image_reduce.type(), SEAM_COLS);
+  if (!image_reduce.empty() && !supprimer_couleur) {
+    cerr << "Erreur : Type de pixel non pris en charge." << endl;
+    return bilan;
+  }
 
-  for (int i = 0; i < rows; ++i) {
-    if (m_cumul[i][cols - 1] < min_val) {
-      min_val = m_cumul[i][cols - 1];
-      min_row = i;
+  // Niveaux de la pyramide : niveaux[0] est image_gradient lui-même
+  vector<Mat> niveaux(1, image_gradient);
+  {
+    PROFIL_ETAPE("pyramide");
+    for (int k = 1; k <= options.pyramide; ++k) {
+      const Mat &fin = niveaux[k - 1];
+      if ((fin.cols + 1) / 2 < PYRAMIDE_LARGEUR_MIN || fin.rows < 2) {
+        break;
+      }
+      Mat grossier;
+      resize(fin, grossier, Size((fin.cols + 1) / 2, (fin.rows + 1) / 2), 0,
+             0, INTER_AREA);
+      niveaux.push_back(grossier);
     }
   }
+  int nb_niveaux = (int)niveaux.size() - 1;
+  vector<int> chemins((size_t)max(nb_niveaux, 1) * rows);
+  vector<int> centre(rows);
+
+  for (int tour = 0; tour < NB_TOUR; ++tour) {
+    niveaux[0] = image_gradient;
+    while (nb_niveaux > 0 &&
+           niveaux[nb_niveaux].cols < PYRAMIDE_LARGEUR_MIN) {
+      --nb_niveaux;
+    }
 
-  way[0] = min_row;
-
-  // Étape 2 : Revenir colonne par colonne
-  for (int j = cols - 2, k = 1; j >= 0; --j, ++k) {
-    int prev_row = way[k - 1];
-    min_row = prev_row; // Par défaut, la ligne actuelle est le minimum
-    min_val = m_cumul[prev_row][j];
-
-    // Vérifier les lignes adjacentes
-    for (int offset = -1; offset <= 1; ++offset) {
-      int adj_row = prev_row + offset;
-      if (adj_row >= 0 && adj_row < rows && m_cumul[adj_row][j] < min_val) {
-        min_val = m_cumul[adj_row][j];
-        min_row = adj_row;
+    // Niveau le plus grossier : matrice complète, puis affinage niveau par
+    // niveau dans un couloir autour du chemin projeté
+    {
+      PROFIL_ETAPE("matrice");
+      const Mat &grossier = niveaux[nb_niveaux];
+      int *way = nb_niveaux > 0
+                     ? chemins.data() + (size_t)(nb_niveaux - 1) * rows
+                     : ws.way;
+      matriceCumulativeCols(grossier, ws.m_cumul);
+      findWayCols(grossier, ws.m_cumul, way);
+      for (int k = nb_niveaux - 1; k >= 0; --k) {
+        const Mat &fin = niveaux[k];
+        const Mat &dessus = niveaux[k + 1];
+        projeterChemin(chemins.data() + (size_t)k * rows, dessus.rows,
+                       dessus.cols, centre.data(), fin.rows, fin.cols);
+        way = k > 0 ? chemins.data() + (size_t)(k - 1) * rows : ws.way;
+        matriceCumulativeColsCouloir(fin, ws.m_cumul, centre.data(), largeur);
+        findWayColsCouloir(fin, ws.m_cumul, centre.data(), largeur, way);
+      }
+    }
+    bilan.energie +=
+        ws.m_cumul[(size_t)(image_gradient.rows - 1) * image_gradient.cols +
+                   ws.way[0]];
+    ++bilan.passes;
+
+    {
+      PROFIL_ETAPE("suppression");
+      supprimer_energie(image_gradient, ws.way);
+      if (supprimer_couleur) {
+        supprimer_couleur(image_reduce, ws.way);
       }
     }
 
-    way[k] = min_row; // Enregistrer la ligne trouvée
+    // Le niveau k perd une colonne tous les 2^k seams de l'image
+    {
+      PROFIL_ETAPE("pyramide");
+      for (int k = 1; k <= nb_niveaux; ++k) {
+        if ((tour + 1) % (1 << k) == 0 && niveaux[k].cols > 1) {
+          supprimer_energie(niveaux[k],
+                            chemins.data() + (size_t)(k - 1) * rows);
+        }
+      }
+    }
+    if (locale) {
+      PROFIL_ETAPE("energie locale");
+      majEnergieLocale(*locale, image_gradient, ws.way, 1);
+    }
+    if (ordre) {
+      PROFIL_ETAPE("ordre");
+      noterOrdre(*ordre, indices, ws.way, 1, tour);
+    }
   }
-
-  return way;
-} // Fin findWayRows
+  if (img_seamed) {
+    PROFIL_ETAPE("imageSeamed");
+    *img_seamed = seamsIndex(*img_seamed, *ordre, NB_TOUR);
+  }
+  return bilan;
+} // Fin boucleSeamsColsPyramide
 
 /**
- * Supprime un pixel d'une image en niveaux de gris, décale les pixels de la
- * ligne vers la gauche, et remplace le dernier pixel par un pixel blanc (255).
+ * Cadre des pixels du masque : lignes [haut, bas] et colonnes
+ * [gauche, droite], cherchées dans les colonnes [debut, fin) des lignes dont
+ * le compte de pixels est non nul.
  *
- * @param image Image en niveaux de gris (type CV_8UC1)
- * @param row Ligne où effectuer l'opération
- * @param col Colonne du pixel à supprimer
+ * @return false si le masque est vide
  */
-inline void removePixelAndShiftLeftGray(Mat &image, int row, int col) {
-  // Vérification des dimensions
-  if (row < 0 || row >= image.rows || col < 0 || col >= image.cols) {
-    cerr << "Erreur : Indices hors limites (row=" << row << ", col=" << col
-         << ")." << endl;
-    return;
+static bool cadreMasque(const Mat &masque, const vector<int> &compte,
+                        int debut, int fin, int &haut, int &bas, int &gauche,
+                        int &droite) {
+  haut = 0;
+  bas = (int)compte.size() - 1;
+  while (haut <= bas && compte[haut] == 0) {
+    ++haut;
   }
-
-  // Décalage des pixels vers la gauche
-  uchar *row_ptr = image.ptr<uchar>(row);
-  for (int c = col; c < image.cols - 1; ++c) {
-    row_ptr[c] = row_ptr[c + 1];
+  while (bas >= haut && compte[bas] == 0) {
+    --bas;
   }
-
-  // Remplacement du dernier pixel par blanc (255)
-  row_ptr[image.cols - 1] = 255;
-} // Fin removePixelAndShiftLeftGray
+  if (haut > bas) {
+    return false;
+  }
+  gauche = fin;
+  droite = debut - 1;
+  for (int i = haut; i <= bas; ++i) {
+    if (compte[i] == 0) {
+      continue;
+    }
+    const uchar *m = masque.ptr<uchar>(i);
+    int j = debut;
+    while (j < gauche && !m[j]) {
+      ++j;
+    }
+    gauche = min(gauche, j);
+    j = fin - 1;
+    while (j > droite && !m[j]) {
+      --j;
+    }
+    droite = max(droite, j);
+  }
+  return true;
+} // Fin cadreMasque
 
 /**
- * Supprime un pixel d'une image en niveaux de gris, décale les pixels de la
- * colonne vers le haut, et remplace le dernier pixel par un pixel blanc (255).
+ * Boucle de suppression d'objet : les seams colonnes sont retirés jusqu'à ce
+ * que le masque soit vide (ou NB_TOUR seams). Les pixels du masque ont une
+ * énergie très négative, si bien que chaque seam en traverse un par ligne
+ * partout où c'est possible.
  *
- * @param image Image en niveaux de gris (type CV_8UC1)
- * @param row Ligne où effectuer l'opération
- * @param col Colonne du pixel à supprimer
+ * Seules les colonnes du cadre du masque, élargi de marge de chaque côté,
+ * sont calculées : la matrice cumulative, le chemin et la compaction
+ * coûtent O(rows x largeur du cadre) au lieu de O(rows x cols), et le cadre
+ * se resserre à mesure que le masque se vide. Les pixels hors de la fenêtre
+ * ne sont jamais touchés. Chaque seam ne décale que les pixels situés avant
+ * la fin de la fenêtre de départ, où les pixels morts s'accumulent ; ils
+ * sont retirés en une passe à la fin.
+ *
+ * @param image_reduce Image couleur, réduite sur place (ou vide)
+ * @param image_gradient Énergie de l'image, réduite sur place
+ * @param masque Pixels à retirer (non nuls), CV_8UC1, réduit sur place
+ * @param img_seamed Image couleur d'origine, sur laquelle les seams sont
+ * tracés une fois à la fin, ou nullptr
+ * @param NB_TOUR Nombre maximal de seams, 0 pour vider le masque
+ * @param marge Colonnes ajoutées de chaque côté du cadre, où les seams
+ * peuvent contourner l'objet au-dessus et au-dessous de lui (0 : toute
+ * l'image)
+ * @param ws Espace de travail alloué pour un chemin
+ * @return Bilan de la suppression (passes : nombre de seams retirés)
  */
-inline void removePixelAndShiftUpGray(Mat &image, int row, int col) {
-  // Vérification des dimensions
-  if (row < 0 || row >= image.rows || col < 0 || col >= image.cols) {
-    cerr << "Erreur : Indices hors limites (row=" << row << ", col=" << col
-         << ")." << endl;
-    return;
+BilanSeams boucleSeamsColsMasque(Mat &image_reduce, Mat &image_gradient,
+                                 Mat &masque, Mat *img_seamed, int NB_TOUR,
+                                 int marge, SeamWorkspace &ws) {
+  BilanSeams bilan;
+  int rows = image_gradient.rows;
+  int cols = image_gradient.cols;
+
+  // Nombre de pixels du masque sur chaque ligne, et cadre de départ
+  vector<int> compte(rows);
+  for (int i = 0; i < rows; ++i) {
+    compte[i] = countNonZero(masque.row(i));
   }
-
-  // Décalage des pixels vers le haut
-  for (int r = row; r < image.rows - 1; ++r) {
-    image.at<uchar>(r, col) = image.at<uchar>(r + 1, col);
+  int haut, bas, gauche, droite;
+  if (!cadreMasque(masque, compte, 0, cols, haut, bas, gauche, droite)) {
+    return bilan;
+  }
+  int limite = (NB_TOUR > 0) ? min(NB_TOUR, cols - 1) : cols - 1;
+  if (marge <= 0) {
+    marge = cols;
   }
 
-  // Remplacement du dernier pixel par blanc (255)
-  image.at<uchar>(image.rows - 1, col) = 255;
-} // Fin removePixelAndShiftUpGray
+  // Un chemin traverse au plus bas - haut + 1 pixels du masque : le bonus
+  // l'emporte sur l'énergie d'une ligne entière tant que les sommes tiennent
+  // dans un int
+  long long energie_max = 255LL * rows;
+  int bonus = (int)min(energie_max + 1,
+                       (INT_MAX / 2 - energie_max) / (bas - haut + 1));
 
-/**
- * Suppression du chemin sur l'image.
- *
- * @param image ImaseamCarvinge Type de seam (SEAM_ROWS ou SEAM_COLS).
- * @return Image réduite après suppression du chemin.
- */
-inline Mat suppressionSeamGray(const Mat &image, const int *way,
-                               int seam_type) {
-  // Cloner l'image pour préserver l'originale
-  Mat reduced_img = image.clone();
+  // Les pixels morts s'accumulent avant la colonne fin_zone, fixe
+  int fin_zone = min(droite + 1 + marge, cols);
 
-  // Initialisation de l'indice pour parcourir le tableau `way`
-  int k = 0;
+  Mat ordre, indices;
+  if (img_seamed) {
+    ordre = Mat(rows, cols, CV_32S, Scalar(INT_MAX));
+    indices = indicesOrigine(rows, cols);
+  }
+
+  while (bilan.passes < limite) {
+    int fin_vivante = fin_zone - bilan.passes;
+    int debut = max(gauche - marge, 0);
+    int fin = min(droite + 1 + marge, fin_vivante);
 
-  // Suppression du chemin pour chaque type de seam
-  if (seam_type == SEAM_COLS) {
-    // Suppression colonne par colonne en partant de la dernière ligne
-    for (int i = reduced_img.rows - 1; i >= 0; --i) {
-      removePixelAndShiftLeftGray(reduced_img, i, way[k]);
-      ++k;
+    {
+      PROFIL_ETAPE("matrice");
+      matriceCumulativeColsMasque(image_gradient, masque, ws.m_cumul, debut,
+                                  fin, bonus);
     }
-  } else if (seam_type == SEAM_ROWS) {
-    // Suppression ligne par ligne en partant de la dernière colonne
-    for (int i = reduced_img.cols - 1; i >= 0; --i) {
-      removePixelAndShiftUpGray(reduced_img, way[k], i);
-      ++k;
+    {
+      PROFIL_ETAPE("chemin");
+      findWayColsMasque(image_gradient, ws.m_cumul, debut, fin, ws.way);
+    }
+
+    int sur_masque = 0;
+    for (int l = 0; l < rows; ++l) {
+      int i = rows - 1 - l;
+      if (masque.at<uchar>(i, ws.way[l])) {
+        --compte[i];
+        ++sur_masque;
+      }
+    }
+    if (sur_masque == 0) {
+      // Le masque n'est plus atteint : les seams suivants seraient inutiles
+      break;
+    }
+    bilan.energie += ws.m_cumul[(size_t)(rows - 1) * cols + ws.way[0]] +
+                     (long long)bonus * sur_masque;
+
+    if (img_seamed) {
+      PROFIL_ETAPE("ordre");
+      for (int l = 0; l < rows; ++l) {
+        int i = rows - 1 - l;
+        ordre.at<int>(i, indices.at<int>(i, ws.way[l])) = bilan.passes;
+      }
+      suppressionSeamColsBornee(indices, ws.way, fin_vivante);
+    }
+    {
+      PROFIL_ETAPE("suppression");
+      suppressionSeamColsBornee(image_gradient, ws.way, fin_vivante);
+      suppressionSeamColsBornee(masque, ws.way, fin_vivante);
+      if (!image_reduce.empty()) {
+        suppressionSeamColsBornee(image_reduce, ws.way, fin_vivante);
+      }
+    }
+    ++bilan.passes;
+
+    if (!cadreMasque(masque, compte, debut, fin, haut, bas, gauche, droite)) {
+      break;
     }
-  } else {
-    // Gestion des erreurs : type de seam invalide
-    cerr << "Erreur : Type de seam non valide." << endl;
   }
 
-  return reduced_img;
-} // fin suppressionSeam
+  int restants = 0;
+  for (int c : compte) {
+    restants += c;
+  }
+  if (restants > 0) {
+    cerr << "Attention : " << restants << " pixels du masque restent après "
+         << bilan.passes << " seams." << endl;
+  }
+
+  // Retrait des pixels morts, en une passe
+  {
+    PROFIL_ETAPE("suppression");
+    int debut_morts = fin_zone - bilan.passes;
+    retirerColonnes(image_gradient, debut_morts, fin_zone);
+    retirerColonnes(masque, debut_morts, fin_zone);
+    if (!image_reduce.empty()) {
+      retirerColonnes(image_reduce, debut_morts, fin_zone);
+    }
+  }
+  if (img_seamed) {
+    PROFIL_ETAPE("imageSeamed");
+    *img_seamed = seamsIndex(*img_seamed, ordre, bilan.passes);
+  }
+  return bilan;
+} // Fin boucleSeamsColsMasque
 
 /**
- * Supprime un pixel d'une image couleur, décale les pixels de la
- * ligne vers la gauche, et remplace le dernier pixel par un pixel blanc (255).
+ * Boucle de suppression des seams colonnes pour une image d'une séquence,
+ * sur place.
+ *
+ * Si couloir est vrai, seams contient en entrée les chemins de l'image
+ * précédente, tour par tour : chaque seam est cherché dans un couloir autour
+ * du chemin de même rang (voir matriceCumulativeColsCouloir), ce qui coûte
+ * bien moins qu'une matrice complète et garde les seams stables d'une image
+ * à l'autre. Sinon, le carving est exact. Dans les deux cas, les chemins
+ * trouvés remplacent ceux de seams pour l'image suivante.
  *
- * @param image Image en couleur
- * @param row Ligne où effectuer l'opération
- * @param col Colonne du pixel à supprimer
+ * @param image_reduce Image couleur, réduite sur place
+ * @param image_gradient Énergie de l'image, réduite sur place
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param ws Espace de travail alloué pour la taille des images
+ * @param seams Chemins de chaque tour (NB_TOUR x rows cases)
+ * @param couloir Vrai si seams contient les chemins de l'image précédente
+ * @param largeur Demi-largeur du couloir
  */
-inline void removePixelAndShiftLeftColor(Mat &image, int row, int col) {
-  if (row < 0 || row >= image.rows || col < 0 || col >= image.cols) {
-    cerr << "Erreur : Indices hors limites (row=" << row << ", col=" << col
-         << ")." << endl;
+void boucleSeamsColsSequence(Mat &image_reduce, Mat &image_gradient,
+                             int NB_TOUR, SeamWorkspace &ws, int *seams,
+                             bool couloir, int largeur) {
+  int rows = image_gradient.rows;
+  SuppressionSeamFn supprimer_energie = suppressionSeamPour(CV_8UC1, SEAM_COLS);
+  SuppressionSeamFn supprimer_couleur =
+      suppressionSeamPour(image_reduce.type(), SEAM_COLS);
+  if (!supprimer_couleur) {
+    cerr << "Erreur : Type de pixel non pris en charge." << endl;
     return;
   }
+  for (int tour = 0; tour < NB_TOUR; ++tour) {
+    int *way = seams + (size_t)tour * rows;
+
+    // Calcul de la matrice cumulative et du chemin minimal
+    if (couloir) {
+      {
+        PROFIL_ETAPE("matrice");
+        matriceCumulativeColsCouloir(image_gradient, ws.m_cumul, way,
+                                     largeur);
+      }
+      PROFIL_ETAPE("chemin");
+      findWayColsCouloir(image_gradient, ws.m_cumul, way, largeur, ws.way);
+    } else {
+      {
+        PROFIL_ETAPE("matrice");
+        if (tour > 0) {
+          majMatriceCumulativeCols(image_gradient, ws.m_cumul, ws.way);
+        } else {
+          matriceCumulativeCols(image_gradient, ws.m_cumul);
+        }
+      }
+      PROFIL_ETAPE("chemin");
+      findWayCols(image_gradient, ws.m_cumul, ws.way);
+    }
+    memcpy(way, ws.way, rows * sizeof(int));
 
-  for (int c = col; c < image.cols - 1; ++c) {
-    image.at<Vec3b>(row, c) = image.at<Vec3b>(row, c + 1);
+    // Suppression du chemin dans les différentes images
+    PROFIL_ETAPE("suppression");
+    supprimer_energie(image_gradient, ws.way);
+    supprimer_couleur(image_reduce, ws.way);
   }
-
-  image.at<Vec3b>(row, image.cols - 1) = Vec3b(255, 255, 255);
-} // Fin removePixelAndShiftLeftColor
+} // Fin boucleSeamsColsSequence
 
 /**
- * Supprime un pixel d'une image en couleur, décale les pixels de la
- * colonne vers le haut, et remplace le dernier pixel par un pixel blanc (255).
+ * Choisit l'ordre des seams colonnes et lignes pour réduire une image dans
+ * les deux sens.
+ *
+ * L'ordre est cherché sur une copie de l'image réduite à PLAN_2D_TAILLE
+ * pixels au plus de côté, où chaque seam en représente plusieurs : à chaque
+ * tour, le seam colonne et le seam ligne de coût minimal sont calculés, et
+ * celui dont l'énergie moyenne par pixel est la plus faible est retiré.
+ * Une fois l'un des deux sens épuisé, les seams restants suivent. Les seams
+ * consécutifs d'un même sens sont regroupés : chaque changement de sens
+ * coûte une transposition et une matrice cumulative complète.
  *
- * @param image Image en couleur
- * @param row Ligne où effectuer l'opération
- * @param col Colonne du pixel à supprimer
+ * @param image_gray Image en niveaux de gris sur 8 bits
+ * @param nb_cols Nombre de seams colonnes à retirer
+ * @param nb_rows Nombre de seams lignes à retirer
+ * @return Suites de seams à retirer, dans l'ordre : sens (SEAM_COLS ou
+ * SEAM_ROWS) et nombre de seams
  */
-inline void removePixelAndShiftUpColor(Mat &image, int row, int col) {
-  if (row < 0 || row >= image.rows || col < 0 || col >= image.cols) {
-    cerr << "Erreur : Indices hors limites (row=" << row << ", col=" << col
-         << ")." << endl;
-    return;
+vector<pair<int, int>> planifierSeams2D(const Mat &image_gray, int nb_cols,
+                                       int nb_rows) {
+  vector<pair<int, int>> plan;
+  auto ajouter = [&plan](int seam_type, int nombre) {
+    if (nombre <= 0) {
+      return;
+    }
+    if (!plan.empty() && plan.back().first == seam_type) {
+      plan.back().second += nombre;
+    } else {
+      plan.emplace_back(seam_type, nombre);
+    }
+  };
+  if (nb_cols <= 0 || nb_rows <= 0) {
+    ajouter(SEAM_COLS, nb_cols);
+    ajouter(SEAM_ROWS, nb_rows);
+    return plan;
   }
 
-  for (int r = row; r < image.rows - 1; ++r) {
-    image.at<Vec3b>(r, col) = image.at<Vec3b>(r + 1, col);
+  // Image réduite et nombre de seams à y retirer dans chaque sens (au moins
+  // un, et il doit rester une colonne et une ligne)
+  double echelle = min(1.0, (double)PLAN_2D_TAILLE /
+                                max(image_gray.rows, image_gray.cols));
+  Mat petite = image_gray;
+  if (echelle < 1.0) {
+    resize(image_gray, petite,
+           Size(max(2, (int)lround(image_gray.cols * echelle)),
+                max(2, (int)lround(image_gray.rows * echelle))),
+           0, 0, INTER_AREA);
   }
-
-  image.at<Vec3b>(image.rows - 1, col) = Vec3b(255, 255, 255);
-} // Fin removePixelAndShiftUpColor
+  Mat energie = filtreEnergie(petite);
+  int petits_cols =
+      min(max(1, (int)lround((double)nb_cols * energie.cols / image_gray.cols)),
+          energie.cols - 1);
+  int petits_rows =
+      min(max(1, (int)lround((double)nb_rows * energie.rows / image_gray.rows)),
+          energie.rows - 1);
+
+  vector<int> cumul_cols((size_t)energie.rows * energie.cols);
+  vector<int> cumul_rows((size_t)energie.rows * energie.cols);
+  vector<int> way(max(energie.rows, energie.cols));
+  SuppressionSeamFn supprimer = suppressionSeamPour(CV_8UC1, SEAM_COLS);
+  Mat energie_t;
+  transpose(energie, energie_t);
+  int faits_cols = 0, faits_rows = 0;
+  int seams_cols = 0, seams_rows = 0;
+  while (faits_cols < petits_cols && faits_rows < petits_rows) {
+    matriceCumulativeCols(energie, cumul_cols.data());
+    matriceCumulativeCols(energie_t, cumul_rows.data());
+    const int *derniere_cols =
+        cumul_cols.data() + (size_t)(energie.rows - 1) * energie.cols;
+    const int *derniere_rows =
+        cumul_rows.data() + (size_t)(energie_t.rows - 1) * energie_t.cols;
+    double cout_col =
+        (double)*min_element(derniere_cols, derniere_cols + energie.cols) /
+        energie.rows;
+    double cout_row =
+        (double)*min_element(derniere_rows, derniere_rows + energie_t.cols) /
+        energie_t.rows;
+
+    // Le seam retiré de l'image réduite vaut une part des seams de l'image
+    if (cout_col <= cout_row) {
+      findWayCols(energie, cumul_cols.data(), way.data());
+      supprimer(energie, way.data());
+      transpose(energie, energie_t);
+      ++faits_cols;
+      int seams = (int)lround((double)faits_cols * nb_cols / petits_cols);
+      ajouter(SEAM_COLS, seams - seams_cols);
+      seams_cols = seams;
+    } else {
+      findWayCols(energie_t, cumul_rows.data(), way.data());
+      supprimer(energie_t, way.data());
+      transpose(energie_t, energie);
+      ++faits_rows;
+      int seams = (int)lround((double)faits_rows * nb_rows / petits_rows);
+      ajouter(SEAM_ROWS, seams - seams_rows);
+      seams_rows = seams;
+    }
+  }
+  ajouter(SEAM_COLS, nb_cols - seams_cols);
+  ajouter(SEAM_ROWS, nb_rows - seams_rows);
+  return plan;
+} // Fin planifierSeams2D
 
 /**
- * Suppression du chemin sur l'image couleur.
+ * Mesure une boucle de suppression sur des copies des images, sans tracer
+ * les seams.
  *
- * @param image ImaseamCarvinge Type de seam (SEAM_ROWS ou SEAM_COLS).
- * @return Image réduite après suppression du chemin.
+ * @param image_reduce Image couleur avant suppression, ou vide
+ * @param image_gradient Énergie avant suppression
+ * @param locale Énergie locale avant suppression, ou nullptr
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param options Options du seam carving (tranches, seams_par_passe et
+ * pyramide choisissent la boucle)
+ * @param duree_ms Reçoit la durée de la boucle
+ * @param reduite Reçoit l'image couleur réduite
+ * @return Bilan de la suppression
  */
-inline Mat suppressionSeamColor(const Mat &image, const int *way,
-                                int seam_type) {
-  // Cloner l'image pour préserver l'originale
-  Mat reduced_img = image.clone();
-
-  // Initialisation de l'indice pour parcourir le tableau `way`
-  int k = 0;
+static BilanSeams mesurerCarving(const Mat &image_reduce,
+                                 const Mat &image_gradient,
+                                 const EnergieLocale *locale, int NB_TOUR,
+                                 const SeamOptions &options, double &duree_ms,
+                                 Mat &reduite) {
+  BilanSeams bilan;
+  reduite = image_reduce.clone();
+  Mat gradient = image_gradient.clone();
+  EnergieLocale copie;
+  if (locale) {
+    copie = *locale;
+    copie.gris = locale->gris.clone();
+    copie.table = locale->table.clone();
+  }
+  if (options.tranches > 1) {
+    auto debut = chrono::steady_clock::now();
+    bilan = boucleSeamsColsTranches(reduite, gradient, nullptr, NB_TOUR,
+                                    options.tranches, options);
+    duree_ms =
+        chrono::duration<double, milli>(chrono::steady_clock::now() - debut)
+            .count();
+    return bilan;
+  }
+  SeamWorkspace ws;
+  if (!allouerWorkspace(ws, gradient.rows, gradient.cols,
+                        options.seams_par_passe, options.dp_compact)) {
+    duree_ms = 0;
+    return bilan;
+  }
 
-  // Suppression du chemin pour chaque type de seam
-  if (seam_type == SEAM_COLS) {
-    // Suppression colonne par colonne en partant de la dernière ligne
-    for (int i = reduced_img.rows - 1; i >= 0; --i) {
-      removePixelAndShiftLeftColor(reduced_img, i, way[k]);
-      ++k;
-    }
-  } else if (seam_type == SEAM_ROWS) {
-    // Suppression ligne par ligne en partant de la dernière colonne
-    for (int i = reduced_img.cols - 1; i >= 0; --i) {
-      removePixelAndShiftUpColor(reduced_img, way[k], i);
-      ++k;
-    }
+  auto debut = chrono::steady_clock::now();
+  if (options.seams_par_passe > 1) {
+    bilan = boucleSeamsColsParLots(reduite, gradient, nullptr, NB_TOUR, ws,
+                                   locale ? &copie : nullptr, nullptr,
+                                   options);
+  } else if (options.pyramide > 0) {
+    bilan = boucleSeamsColsPyramide(reduite, gradient, nullptr, NB_TOUR, ws,
+                                    locale ? &copie : nullptr, nullptr,
+                                    options);
   } else {
-    // Gestion des erreurs : type de seam invalide
-    cerr << "Erreur : Type de seam non valide." << endl;
+    bilan = boucleSeamsCols(reduite, gradient, nullptr, NB_TOUR, ws,
+                            locale ? &copie : nullptr, nullptr, options);
   }
+  duree_ms =
+      chrono::duration<double, milli>(chrono::steady_clock::now() - debut)
+          .count();
 
-  return reduced_img;
-} // fin suppressionSeamColor
+  libererWorkspace(ws);
+  return bilan;
+} // Fin mesurerCarving
 
 /**
- * Traçage du chemin sur l'image.
+ * Compare la suppression par lots, par tranches ou par pyramide au carving
+ * exact (un seam par matrice cumulative complète) : écart d'énergie retirée,
+ * accélération et PSNR entre les deux images réduites. Les deux boucles sont
+ * mesurées dans les mêmes conditions, sans tracer les seams.
  *
- * @param image Image en couleurs à modifier.
- * @param way Tableau contenant les indices du chemin minimum.
- * @param nomImage Nom de l'image.
- * @param repertoire Répertoire.
- * @param seam_type Type de seam (SEAM_ROWS ou SEAM_COLS).
- * @return Image contenant le tracé du chemin minimum.
+ * @param image_reduce Image couleur avant suppression, ou vide
+ * @param image_gradient Énergie avant suppression
+ * @param locale Énergie locale avant suppression, ou nullptr
+ * @param NB_TOUR Nombre de seams à retirer
+ * @param options Options du seam carving
  */
-inline Mat imageSeamed(const Mat &image, const int *way, int seam_type) {
-  // Cloner l'image pour préserver l'originale
-  Mat seamed_img = image.clone();
-
-  // Initialisation de l'indice pour parcourir le tableau `way`
-  int k = 0;
-
-  // Traçage du chemin pour chaque type de seam
-  if (seam_type == SEAM_COLS) {
-    // Traçage colonne par colonne en partant de la dernière ligne
-    for (int i = seamed_img.rows - 1; i >= 0; --i) {
-      if (way[k] >= 0 && way[k] < seamed_img.cols) { // Validation des indices
-        seamed_img.at<Vec3b>(i, way[k]) =
-            Vec3b(0, 0, 255); // Marqueur rouge (0, 0, 255)
-      }
-      ++k;
-    }
-  } else if (seam_type == SEAM_ROWS) {
-    // Traçage ligne par ligne en partant de la dernière colonne
-    for (int i = seamed_img.cols - 1; i >= 0; --i) {
-      if (way[k] >= 0 && way[k] < seamed_img.rows) { // Validation des indices
-        seamed_img.at<Vec3b>(way[k], i) =
-            Vec3b(0, 0, 255); // Marqueur rouge (0, 0, 255)
-      }
-      ++k;
-    }
-  } else {
-    // Gestion des erreurs : type de seam invalide
-    cerr << "Erreur : Type de seam non valide." << endl;
+void comparerCarving(const Mat &image_reduce, const Mat &image_gradient,
+                     const EnergieLocale *locale, int NB_TOUR,
+                     const SeamOptions &options) {
+  SeamOptions options_exact = options;
+  options_exact.seams_par_passe = 1;
+  options_exact.tranches = 1;
+  options_exact.pyramide = 0;
+  const char *mode = (options.tranches > 1)          ? "par tranches"
+                     : (options.seams_par_passe > 1) ? "par lots"
+                                                     : "par pyramide";
+
+  double duree_approche, duree_exact;
+  Mat reduite_approche, reduite_exact;
+  BilanSeams approche =
+      mesurerCarving(image_reduce, image_gradient, locale, NB_TOUR, options,
+                     duree_approche, reduite_approche);
+  BilanSeams exact =
+      mesurerCarving(image_reduce, image_gradient, locale, NB_TOUR,
+                     options_exact, duree_exact, reduite_exact);
+
+  cout << "Comparaison : " << mode << " " << approche.energie << " ("
+       << duree_approche << " ms), exact " << exact.energie << " ("
+       << duree_exact << " ms)" << endl;
+  cout << "Écart d'énergie retirée : " << showpos
+       << approche.energie - exact.energie;
+  if (exact.energie > 0) {
+    cout << " (" << 100.0 * (double)(approche.energie - exact.energie) /
+                        exact.energie
+         << " %)";
   }
+  cout << noshowpos << ", accélération : x"
+       << duree_exact / max(duree_approche, 1e-3) << endl;
+  if (!reduite_exact.empty()) {
+    double crete = (reduite_exact.depth() == CV_16U) ? 65535 : 255;
+    cout << "PSNR par rapport au carving exact : "
+         << PSNR(reduite_approche, reduite_exact, crete) << " dB" << endl;
+  }
+} // Fin comparerCarving
 
-  return seamed_img;
-} // Fin imageSeamed
+/**
+ * Affiche le bilan d'une suppression par lots ou par tranches.
+ *
+ * @param bilan Bilan de la suppression (voir SeamCarver::bilan)
+ */
+static void afficherBilan(const BilanSeams &bilan) {
+  if (bilan.tranches > 1) {
+    cout << "Tranches : " << bilan.tranches << ", " << bilan.passes
+         << " seams, énergie retirée " << bilan.energie << ", "
+         << bilan.duree_ms << " ms" << endl;
+  }
+  if (bilan.seams_par_passe > 1) {
+    cout << "Seams par passe : " << bilan.seams_par_passe << ", "
+         << bilan.passes << " passes, énergie retirée " << bilan.energie
+         << ", " << bilan.duree_ms << " ms" << endl;
+  }
+} // Fin afficherBilan
 
 /**
  * Fonction principale qui contient tout l'algorithme du seam carving.
  *
+ * Le carving lui-même est fait en mémoire par un SeamCarver ; cette
+ * fonction gère les fichiers d'index, affiche les bilans et enregistre les
+ * images resized et, si options.image_seamed, seamed dans repertoire.
+ *
  * @param NB_TOUR Nombre de pixels à retirer.
  * @param seam_type SEAM_ROWS ou SEAM_COLS, pour suppression sur lignes ou
- * colonnes.
+ * colonnes, ou SEAM_BOTH pour NB_TOUR seams dans chaque sens sur la même
+ * image (réduction seulement, sans index).
+ * @param options Options du seam carving (voir SeamOptions).
  * @return Image redimensionnée.
  */
 Mat seamCarving(Mat image, Mat image_gray, int NB_TOUR, const string &nomImage,
-                const string &repertoire, int seam_type) {
+                const string &repertoire, int seam_type,
+                const SeamOptions &options) {
+  PROFIL_ETAPE("seamCarving");
 
   // Vérification de la validité de l'image d'entrée
   if (image.empty() || image_gray.empty()) {
@@ -577,87 +3095,130 @@ Mat seamCarving(Mat image, Mat image_gray, int NB_TOUR, const string &nomImage,
     return Mat();
   }
 
-  Mat image_reduce = image.clone();
-  Mat img_seamed = image.clone();
-
-  // Pré-traitement
-  Mat img_gausse = filtreGaussien(image_gray.clone());
-  Mat image_gradient = filtreGradient(img_gausse.clone());
-
-  Mat resized_image;
-
-  // Suppression des seams
-  if (seam_type == SEAM_COLS) {
-    for (int tour = 0; tour < NB_TOUR; ++tour) {
-      // Calcul de la matrice cumulative et du chemin minimal
-      int **m = matriceCumulativeCols(image_gradient);
-      int *way = findWayCols(image_gradient, m);
+  if (seam_type != SEAM_COLS && seam_type != SEAM_ROWS &&
+      seam_type != SEAM_BOTH) {
+    cerr << "Erreur : Type de seam invalide." << endl;
+    return Mat();
+  }
+  if (seam_type == SEAM_BOTH &&
+      (NB_TOUR < 0 || options.creer_index || options.depuis_index)) {
+    cerr << "Erreur : Les deux sens se réduisent sans index ni agrandissement."
+         << endl;
+    return Mat();
+  }
 
-      // Suppression du chemin dans les différentes images
-      image_gradient =
-          suppressionSeamGray(image_gradient.clone(), way, SEAM_COLS);
-      image_reduce = suppressionSeamColor(image_reduce.clone(), way, SEAM_COLS);
-      img_seamed = imageSeamed(img_seamed.clone(), way, SEAM_COLS);
+  // Il doit rester au moins un pixel après la suppression des seams, et les
+  // seams insérés (NB_TOUR négatif) doivent être disjoints
+  int dimension = (seam_type == SEAM_ROWS)   ? image.rows
+                  : (seam_type == SEAM_COLS) ? image.cols
+                                             : min(image.rows, image.cols);
+  if (NB_TOUR <= -dimension || NB_TOUR >= dimension) {
+    cerr << "Erreur : Nombre de seams invalide (" << NB_TOUR << ")." << endl;
+    return Mat();
+  }
 
-      // Libération de la mémoire
-      for (int i = 0; i < image.rows; ++i) {
-        free(m[i]);
+  string suffixe = (seam_type == SEAM_ROWS)   ? "rows-"
+                   : (seam_type == SEAM_COLS) ? "cols-"
+                                              : "both-";
+  string fichier_index = repertoire + "index_" + suffixe +
+                         filesystem::path(nomImage).stem().string() + ".bin";
+
+  SeamCarver carver(options);
+  Mat resized_image, img_seamed;
+  Mat *p_seamed = options.image_seamed ? &img_seamed : nullptr;
+  if (options.creer_index || options.depuis_index) {
+    // Ordre de suppression des pixels, lu ou calculé, dont les images
+    // demandées sont tirées en une passe
+    Mat ordre;
+    if (options.depuis_index) {
+      PROFIL_ETAPE("index");
+      ordre = chargerIndex(fichier_index, seam_type,
+                           seam_type == SEAM_ROWS
+                               ? Size(image.rows, image.cols)
+                               : image.size());
+    } else {
+      ordre = carver.ordreSuppression(image_gray, seam_type);
+    }
+    if (ordre.empty()) {
+      return Mat();
+    }
+    if (options.creer_index) {
+      afficherBilan(carver.bilan());
+      PROFIL_ETAPE("index");
+      if (!sauverIndex(fichier_index, ordre, seam_type)) {
+        return Mat();
       }
-      free(m);
-      free(way);
+      cout << "Index enregistré: " << fichier_index << endl;
     }
+    resized_image =
+        carver.depuisOrdre(image, ordre, NB_TOUR, seam_type, p_seamed);
+  } else {
+    resized_image = carver.redimensionner(std::move(image), NB_TOUR,
+                                          seam_type, p_seamed, image_gray);
+    afficherBilan(carver.bilan());
+  }
+  if (resized_image.empty()) {
+    return Mat();
+  }
 
-    // Redimensionnement et enregistrement
-    int new_height = image_reduce.rows;
-    int new_width = image_reduce.cols - NB_TOUR;
-    resized_image = image_reduce(Rect(0, 0, new_width, new_height));
-
-    // Sauvegarde des images
-    string fichier_modifie = repertoire + "resized_cols-" + nomImage;
-    imwrite(fichier_modifie, resized_image);
-    cout << "Image resized et enregistrée: " << fichier_modifie << endl;
+  // Sauvegarde des images
+  PROFIL_ETAPE("imwrite");
+  string fichier_modifie = repertoire + "resized_" + suffixe + nomImage;
+  imwrite(fichier_modifie, resized_image);
+  cout << "Image resized et enregistrée: " << fichier_modifie << endl;
 
-    fichier_modifie = repertoire + "seamed_cols-" + nomImage;
+  if (options.image_seamed) {
+    fichier_modifie = repertoire + "seamed_" + suffixe + nomImage;
     imwrite(fichier_modifie, img_seamed);
     cout << "Image seamed et enregistrée: " << fichier_modifie << endl;
+  }
 
-  } else if (seam_type == SEAM_ROWS) {
-    for (int tour = 0; tour < NB_TOUR; ++tour) {
-      // Calcul de la matrice cumulative et du chemin minimal
-      int **m = matriceCumulativeRows(image_gradient);
-      int *way = findWayRows(image_gradient, m);
-
-      // Suppression du chemin dans les différentes images
-      image_gradient =
-          suppressionSeamGray(image_gradient.clone(), way, SEAM_ROWS);
-      image_reduce = suppressionSeamColor(image_reduce.clone(), way, SEAM_ROWS);
-      img_seamed = imageSeamed(img_seamed.clone(), way, SEAM_ROWS);
-
-      // Libération de la mémoire
-      for (int i = 0; i < image.rows; ++i) {
-        free(m[i]);
-      }
-      free(m);
-      free(way);
-    }
-
-    // Redimensionnement et enregistrement
-    int new_height = image_reduce.rows - NB_TOUR;
-    int new_width = image_reduce.cols;
-    resized_image = image_reduce(Rect(0, 0, new_width, new_height));
-
-    // Sauvegarde des images
-    string fichier_modifie = repertoire + "resized_rows-" + nomImage;
-    imwrite(fichier_modifie, resized_image);
-    cout << "Image resized et enregistrée: " << fichier_modifie << endl;
+  return resized_image;
+}
+// fin seamCarving
 
-    fichier_modifie = repertoire + "seamed_rows-" + nomImage;
+/**
+ * Suppression d'un objet désigné par un masque (voir
+ * SeamCarver::supprimerObjet) : enregistre les images resized et, si
+ * options.image_seamed, seamed dans repertoire, sous les mêmes noms que
+ * seamCarving.
+ *
+ * @param masque Pixels à retirer (non nuls), CV_8UC1 à la taille de image
+ * @param NB_TOUR Nombre maximal de seams, 0 pour vider le masque
+ * @param seam_type SEAM_ROWS ou SEAM_COLS
+ * @param options Options du seam carving (voir SeamOptions)
+ * @return Image sans l'objet, vide en cas d'erreur
+ */
+Mat seamCarvingMasque(Mat image, Mat image_gray, const Mat &masque,
+                      int NB_TOUR, const string &nomImage,
+                      const string &repertoire, int seam_type,
+                      const SeamOptions &options) {
+  PROFIL_ETAPE("seamCarving");
+
+  SeamCarver carver(options);
+  Mat img_seamed;
+  Mat *p_seamed = options.image_seamed ? &img_seamed : nullptr;
+  Mat resized_image = carver.supprimerObjet(image, masque, seam_type, NB_TOUR,
+                                            p_seamed, image_gray);
+  if (resized_image.empty()) {
+    return Mat();
+  }
+  const BilanSeams &bilan = carver.bilan();
+  cout << "Objet retiré en " << bilan.passes << " seams, énergie retirée "
+       << bilan.energie << ", " << bilan.duree_ms << " ms" << endl;
+
+  // Sauvegarde des images
+  PROFIL_ETAPE("imwrite");
+  string suffixe = (seam_type == SEAM_ROWS) ? "rows-" : "cols-";
+  string fichier_modifie = repertoire + "resized_" + suffixe + nomImage;
+  imwrite(fichier_modifie, resized_image);
+  cout << "Image resized et enregistrée: " << fichier_modifie << endl;
+
+  if (options.image_seamed) {
+    fichier_modifie = repertoire + "seamed_" + suffixe + nomImage;
     imwrite(fichier_modifie, img_seamed);
     cout << "Image seamed et enregistrée: " << fichier_modifie << endl;
-  } else {
-    cerr << "Erreur : Type de seam invalide." << endl;
   }
 
   return resized_image;
-}
-// fin seamCarving
+} // Fin seamCarvingMasque
@@ -8,22 +8,263 @@ using namespace std;
 
 #define SEAM_ROWS 0
 #define SEAM_COLS 1
+#define SEAM_BOTH 2
+
+// Alignement de l'espace de travail (une ligne de cache)
+#define WORKSPACE_ALIGN 64
+
+// Calcul parallèle de la matrice cumulative : hauteur d'une bande de lignes
+// et largeur minimale d'une tuile (au moins 2 * DP_BANDE)
+#define DP_BANDE 64
+#define DP_TUILE 256
+
+// Matrice cumulative compacte : directions de remontée sur 2 bits, quatre
+// colonnes par octet (0 : même colonne, 1 : à gauche, 2 : à droite)
+#define DIRECTION_CENTRE 0
+#define DIRECTION_GAUCHE 1
+#define DIRECTION_DROITE 2
+#define DIRECTIONS_PAR_OCTET 4
+
+// Nombre minimal de lignes par tâche lors de la suppression d'un seam
+#define SUPPRESSION_GRAIN 64
+
+// Nombre minimal de lignes par bande lors du calcul de l'énergie
+#define ENERGIE_GRAIN 32
+
+// Nombre maximal de seams extraits d'une même matrice cumulative
+#define SEAMS_PAR_PASSE_MAX 4096
+
+// Énergie locale : demi-largeur de la bande recalculée autour d'un seam (4
+// suffit pour un seam seul, une colonne de marge pour les seams d'un même
+// lot qui se croisent) et valeur maximale de gx² + gy²
+#define ENERGIE_RAYON 5
+#define CARRE_GRADIENT_MAX (2 * 255 * 255)
+
+// Fichier d'index (ordre de suppression des pixels) : signature "SCIX"
+#define INDEX_SIGNATURE 0x58494353u
+#define INDEX_VERSION 1
+
+// Serveur : signatures des requêtes ("SCRQ") et des réponses ("SCRP"),
+// version du protocole et taille maximale d'une image encodée reçue
+#define SERVEUR_SIGNATURE_REQUETE 0x51524353u
+#define SERVEUR_SIGNATURE_REPONSE 0x50524353u
+#define SERVEUR_VERSION 1
+#define SERVEUR_TAILLE_MAX (256u << 20)
+
+// Séquences d'images : demi-largeur par défaut du couloir autour des seams
+// de l'image précédente
+#define COULOIR_LARGEUR 16
+
+// Traitement hors mémoire : hauteur des bandes de lignes lues, filtrées et
+// écrites à la fois
+#define BANDE_HORS_MEMOIRE 256
+
+// Carving par tranches verticales : une coupure peut glisser d'au plus
+// 1 / TRANCHE_MARGE de la largeur d'une tranche vers une colonne d'énergie
+// forte
+#define TRANCHE_MARGE 4
+
+// Carving dans les deux sens : plus grande dimension de l'image réduite sur
+// laquelle l'ordre des seams colonnes et lignes est choisi
+#define PLAN_2D_TAILLE 128
+
+// Recherche des seams du grossier au fin : nombre maximal de niveaux de la
+// pyramide, et largeur minimale d'un niveau pour qu'il serve encore
+#define PYRAMIDE_NIVEAUX_MAX 6
+#define PYRAMIDE_LARGEUR_MIN 16
+
+/**
+ * Options du seam carving.
+ *
+ * incremental : la matrice cumulative est conservée d'un tour à l'autre et
+ * seule la zone touchée par le seam supprimé est recalculée (résultat
+ * identique à une reconstruction complète).
+ * seams_par_passe : nombre de seams disjoints extraits de chaque matrice
+ * cumulative et supprimés ensemble (1 = carving exact, seam par seam).
+ * comparer : refait aussi le carving exact en mémoire et affiche l'écart
+ * d'énergie retirée, l'accélération obtenue et le PSNR de l'image réduite.
+ * energie_locale : l'énergie est recalculée autour de chaque seam supprimé
+ * au lieu d'être simplement décalée (voir majEnergieLocale).
+ * creer_index : l'image est réduite jusqu'à un pixel de large et l'ordre de
+ * suppression de chaque pixel est enregistré ; les images demandées en sont
+ * ensuite tirées.
+ * depuis_index : les images sont tirées d'un index déjà enregistré, sans
+ * aucun calcul de seam.
+ * dp_compact : la matrice cumulative n'est pas gardée en entier, seulement
+ * une bande de lignes glissante et une direction de remontée sur 2 bits par
+ * pixel (environ 16 fois moins de mémoire, seams identiques). La matrice est
+ * alors reconstruite à chaque seam, un seam par passe.
+ * tranches : au-delà de 1, réduction approchée : l'image est découpée en
+ * autant de tranches verticales, carvées en parallèle et recollées (voir
+ * boucleSeamsColsTranches). Ne s'applique pas à l'agrandissement.
+ * image_seamed : seamCarving enregistre aussi l'image d'origine avec les
+ * seams tracés à leur place.
+ * largeur_couloir : séquences d'images, demi-largeur du couloir dans lequel
+ * les seams sont cherchés autour de ceux de l'image précédente (0 : carving
+ * exact de chaque image) ; avec pyramide, demi-largeur du couloir d'affinage
+ * à chaque niveau (0 : carving exact) ; pour retirer un objet, colonnes
+ * ajoutées de chaque côté de son cadre (0 : toute l'image).
+ * pyramide : au-delà de 0, réduction approchée : chaque seam est cherché sur
+ * l'énergie réduite pyramide fois de moitié, puis affiné niveau par niveau
+ * dans un couloir (voir boucleSeamsColsPyramide).
+ */
+struct SeamOptions {
+  bool incremental = true;
+  int seams_par_passe = 1;
+  bool comparer = false;
+  bool energie_locale = false;
+  bool creer_index = false;
+  bool depuis_index = false;
+  bool dp_compact = false;
+  int tranches = 1;
+  bool image_seamed = true;
+  int largeur_couloir = COULOIR_LARGEUR;
+  int pyramide = 0;
+};
+
+/**
+ * Espace de travail réutilisé pour chaque seam (voir allouerWorkspace).
+ *
+ * m_cumul : matrice cumulative contiguë, au pas de la largeur logique (en
+ * mode compact, bande glissante de DP_BANDE + 1 lignes seulement).
+ * way : chemins des seams courants, un bloc de max(rows, cols) par seam.
+ * pris : pixels déjà pris par un seam de la passe (seams par lot seulement).
+ * directions : directions de remontée sur 2 bits (mode compact seulement).
+ */
+struct SeamWorkspace {
+  int *m_cumul = nullptr;
+  int *way = nullptr;
+  unsigned char *pris = nullptr;
+  unsigned char *directions = nullptr;
+  int rows = 0;
+  int cols = 0;
+};
+
+/**
+ * État de l'énergie locale, réduit avec l'image à chaque seam.
+ *
+ * gris : image en niveaux de gris.
+ * histogramme : nombre de pixels pour chaque valeur de gx² + gy².
+ * carre_min, carre_max : bornes courantes de gx² + gy².
+ * table : énergie pour chaque valeur de gx² + gy² entre les bornes.
+ */
+struct EnergieLocale {
+  Mat gris;
+  vector<int> histogramme;
+  int carre_min = 0;
+  int carre_max = 0;
+  Mat table;
+};
+
+/**
+ * Bilan d'une boucle de suppression : énergie retirée (somme de l'énergie des
+ * pixels supprimés) et nombre de matrices cumulatives exploitées.
+ *
+ * seams_par_passe, duree_ms : renseignés par SeamCarver, taille des lots
+ * utilisée et durée de la boucle.
+ * tranches : nombre de tranches effectivement carvées (voir
+ * boucleSeamsColsTranches).
+ */
+struct BilanSeams {
+  long long energie = 0;
+  int passes = 0;
+  int seams_par_passe = 1;
+  int tranches = 1;
+  double duree_ms = 0;
+};
+
+/**
+ * Suppression d'un seam sur place, pour un type de pixel et un sens de seam
+ * donnés (voir suppressionSeamPour).
+ */
+typedef void (*SuppressionSeamFn)(Mat &image, const int *way);
 
 Mat filtreGaussien(const Mat &image);
 Mat filtreGradient(const Mat &image);
-int **matriceCumulativeCols(const Mat &image);
-int **matriceCumulativeRows(const Mat &image);
-int *findWayCols(const Mat &image, int **m_cumul);
-int *findWayRows(const Mat &image, int **m_cumul);
-inline void removePixelAndShiftLeftGray(Mat &image, int row, int col);
-inline void removePixelAndShiftUpGray(Mat &image, int row, int col);
-inline Mat suppressionSeamGray(const Mat &image, const int *way, int seam_type);
-inline void removePixelAndShiftLeftColor(Mat &image, int row, int col);
-inline void removePixelAndShiftUpColor(Mat &image, int row, int col);
-inline Mat suppressionSeamColor(const Mat &image, const int *way,
-                                int seam_type);
-inline Mat imageSeamed(const Mat &image, const int *way, int seam_type);
+Mat imageGris(const Mat &image);
+Mat filtreEnergie(const Mat &image);
+Mat tableEnergie(int carre_min, int carre_max);
+void bornesEnergieBande(const Mat &gris, int debut, int fin, int &carre_min,
+                        int &carre_max);
+void energieBande(const Mat &gris, int debut, int fin, const Mat &table,
+                  int carre_min, Mat &energie);
+void initEnergieLocale(EnergieLocale &el, const Mat &image, Mat &energie);
+bool majEnergieLocale(EnergieLocale &el, Mat &energie, const int *ways,
+                      int nb_seams);
+bool allouerWorkspace(SeamWorkspace &ws, int rows, int cols,
+                      int seams_par_passe = 1, bool compacte = false,
+                      unsigned char *directions = nullptr);
+void libererWorkspace(SeamWorkspace &ws);
+void matriceCumulativeCols(const Mat &image, int *m_cumul);
+void matriceCumulativeRows(const Mat &image, int *m_cumul);
+void matriceCumulativeColsCouloir(const Mat &image, int *m_cumul,
+                                  const int *centre, int largeur);
+void matriceCumulativeColsCompacte(const Mat &image, int *bande,
+                                   unsigned char *directions);
+void matriceCumulativeColsCompacte(const Mat &image, int *bande,
+                                   unsigned char *directions, int debut,
+                                   int fin);
+void majMatriceCumulativeCols(const Mat &image, int *m_cumul, const int *way);
+void majMatriceCumulativeRows(const Mat &image, int *m_cumul, const int *way);
+void findWayCols(const Mat &image, const int *m_cumul, int *way);
+void findWayRows(const Mat &image, const int *m_cumul, int *way);
+void findWayColsCompacte(const Mat &image, const int *derniere,
+                         const unsigned char *directions, int *way);
+void matriceCumulativeColsMasque(const Mat &image, const Mat &masque,
+                                 int *m_cumul, int debut, int fin, int bonus);
+void findWayColsMasque(const Mat &image, const int *m_cumul, int debut,
+                       int fin, int *way);
+void findWayColsCouloir(const Mat &image, const int *m_cumul,
+                        const int *centre, int largeur, int *way);
+int findWaysColsDisjoints(const Mat &image, const int *m_cumul, int *ways,
+                          int nb_seams, unsigned char *pris,
+                          long long &energie);
+bool pixelPrisEnCharge(int type);
+SuppressionSeamFn suppressionSeamPour(int type, int seam_type);
+void suppressionSeamGray(Mat &image, const int *way, int seam_type);
+void suppressionSeamColor(Mat &image, const int *way, int seam_type);
+void suppressionSeamsCols(Mat &image, const int *ways, int nb_seams);
+void suppressionSeamColsBornee(Mat &image, const int *way, int fin);
+void retirerColonnes(Mat &image, int debut, int fin);
+BilanSeams boucleSeamsCols(Mat &image_reduce, Mat &image_gradient,
+                           Mat *img_seamed, int NB_TOUR, SeamWorkspace &ws,
+                           EnergieLocale *locale, Mat *ordre,
+                           const SeamOptions &options);
+BilanSeams boucleSeamsColsParLots(Mat &image_reduce, Mat &image_gradient,
+                                  Mat *img_seamed, int NB_TOUR,
+                                  SeamWorkspace &ws, EnergieLocale *locale,
+                                  Mat *ordre, const SeamOptions &options);
+BilanSeams boucleSeamsColsTranches(Mat &image_reduce, Mat &image_gradient,
+                                   Mat *img_seamed, int NB_TOUR,
+                                   int nb_tranches,
+                                   const SeamOptions &options);
+BilanSeams boucleSeamsColsPyramide(Mat &image_reduce, Mat &image_gradient,
+                                   Mat *img_seamed, int NB_TOUR,
+                                   SeamWorkspace &ws, EnergieLocale *locale,
+                                   Mat *ordre, const SeamOptions &options);
+BilanSeams boucleSeamsColsMasque(Mat &image_reduce, Mat &image_gradient,
+                                 Mat &masque, Mat *img_seamed, int NB_TOUR,
+                                 int marge, SeamWorkspace &ws);
+void boucleSeamsColsSequence(Mat &image_reduce, Mat &image_gradient,
+                             int NB_TOUR, SeamWorkspace &ws, int *seams,
+                             bool couloir, int largeur);
+bool sauverIndex(const string &fichier, const Mat &ordre, int seam_type);
+Mat chargerIndex(const string &fichier, int seam_type, Size taille);
+bool verifierOrdre(const Mat &ordre);
+Mat redimensionnerIndex(const Mat &image, const Mat &ordre, int NB_TOUR);
+Mat agrandirIndex(const Mat &image, const Mat &ordre, int nb_seams);
+Mat seamsIndex(const Mat &image, const Mat &ordre, int NB_TOUR);
+vector<pair<int, int>> planifierSeams2D(const Mat &image_gray, int nb_cols,
+                                       int nb_rows);
+void comparerCarving(const Mat &image_reduce, const Mat &image_gradient,
+                     const EnergieLocale *locale, int NB_TOUR,
+                     const SeamOptions &options);
 Mat seamCarving(Mat image, Mat image_gray, int NB_TOUR, const string &nomImage,
-                const string &repertoire, int seam_type);
+                const string &repertoire, int seam_type,
+                const SeamOptions &options = SeamOptions());
+Mat seamCarvingMasque(Mat image, Mat image_gray, const Mat &masque,
+                      int NB_TOUR, const string &nomImage,
+                      const string &repertoire, int seam_type,
+                      const SeamOptions &options = SeamOptions());
 
 #endif
\ No newline at end of file
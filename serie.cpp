@@ -0,0 +1,264 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <system_error>
+#include <tbb/enumerable_thread_specific.h>
+#include <tbb/parallel_pipeline.h>
+#include <tbb/task_arena.h>
+#include <vector>
+
+#include "profil.h"
+#include "seamcarver.h"
+#include "seamcarving.h"
+#include "serie.h"
+#include "video.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * Image de la série en vol dans le pipeline.
+ *
+ * chemin : fichier d'origine
+ * image : image lue, libérée une fois carvée
+ * resized, seamed : images produites, une par type de seam demandé
+ * ok : faux si la lecture ou le carving a échoué
+ */
+struct ImageSerie {
+  filesystem::path chemin;
+  Mat image;
+  vector<Mat> resized;
+  vector<Mat> seamed;
+  bool ok = true;
+};
+
+/**
+ * Lit un fichier liste : un chemin d'image par ligne, tel quel (relatif au
+ * répertoire courant). Les lignes vides et celles qui commencent par '#'
+ * sont ignorées.
+ *
+ * @param fichier Fichier liste
+ * @param chemins Reçoit les chemins, dans l'ordre du fichier
+ * @return false si le fichier n'a pas pu être lu
+ */
+static bool lireListe(const string &fichier,
+                      vector<filesystem::path> &chemins) {
+  ifstream liste(fichier);
+  if (!liste) {
+    perror(fichier.c_str());
+    return false;
+  }
+  string ligne;
+  while (getline(liste, ligne)) {
+    if (!ligne.empty() && ligne.back() == '\r') {
+      ligne.pop_back();
+    }
+    if (!ligne.empty() && ligne[0] != '#') {
+      chemins.push_back(ligne);
+    }
+  }
+  return true;
+} // Fin lireListe
+
+/**
+ * Seam carving d'une série d'images.
+ *
+ * Le pipeline compte trois étapes, toutes parallèles, et garde au plus deux
+ * images par thread en vol :
+ *  - lecture : chaque fichier est décodé une fois (IMREAD_UNCHANGED, ou en
+ *    BGR sur 8 bits pour les types non pris en charge), et l'image en
+ *    niveaux de gris en est tirée (voir imageGris) au lieu d'être relue ;
+ *  - carving : un SeamCarver par thread, dont l'espace de travail sert
+ *    d'une image à l'autre, et jamais à deux images à la fois (le carving
+ *    est isolé). Pour plusieurs types de seams, chacun part de l'image
+ *    d'origine, comme en ligne de commande ;
+ *  - écriture : les images sont encodées et enregistrées pendant que les
+ *    suivantes sont carvées.
+ *
+ * Chaque image est enregistrée dans Images/<nom sans extension>/, sous les
+ * mêmes noms qu'en ligne de commande : deux images de même nom sans
+ * extension sont refusées avant le début de la série. Une image illisible ou
+ * trop petite est signalée et n'arrête pas la série.
+ *
+ * @param source Répertoire d'images ou fichier liste
+ * @param NB_TOUR Nombre de seams à retirer (à insérer s'il est négatif)
+ * @param seam_types Types de seam à appliquer à chaque image (SEAM_COLS,
+ * SEAM_ROWS, SEAM_BOTH)
+ * @param options Options du seam carving (ni index, ni vidéo)
+ * @return Nombre d'images traitées, -1 si la source est illisible ou si
+ * aucune image n'a pu être traitée
+ */
+int seamCarvingSerie(const string &source, int NB_TOUR,
+                     const vector<int> &seam_types,
+                     const SeamOptions &options) {
+  if (seam_types.empty()) {
+    cerr << "Erreur : Type de seam invalide." << endl;
+    return -1;
+  }
+  for (int seam_type : seam_types) {
+    if (seam_type != SEAM_COLS && seam_type != SEAM_ROWS &&
+        seam_type != SEAM_BOTH) {
+      cerr << "Erreur : Type de seam invalide." << endl;
+      return -1;
+    }
+  }
+  if (options.creer_index || options.depuis_index) {
+    cerr << "Erreur : Les options d'index ne s'appliquent pas aux séries."
+         << endl;
+    return -1;
+  }
+
+  // Liste des images
+  vector<filesystem::path> chemins;
+  if (filesystem::is_directory(source)) {
+    chemins = listerImages(source);
+  } else if (!lireListe(source, chemins)) {
+    return -1;
+  }
+  if (chemins.empty()) {
+    cerr << "Erreur : Aucune image dans " << source << "." << endl;
+    return -1;
+  }
+  // Deux images de même nom sans extension seraient écrites ensemble dans le
+  // même répertoire de sortie
+  map<string, filesystem::path> noms;
+  for (const filesystem::path &chemin : chemins) {
+    auto insertion = noms.emplace(chemin.stem().string(), chemin);
+    if (!insertion.second) {
+      cerr << "Erreur : " << insertion.first->second.string() << " et "
+           << chemin.string() << " seraient enregistrées dans le même "
+           << "répertoire (Images/" << insertion.first->first << "/)."
+           << endl;
+      return -1;
+    }
+  }
+
+  // Un SeamCarver par thread, créé à sa première image. Le carving lance
+  // lui-même des boucles parallèles : il est isolé, pour qu'un thread qui
+  // attend la fin d'une de ces boucles ne prenne pas le carving d'une autre
+  // image, qui reprendrait le même SeamCarver en plein travail.
+  tbb::enumerable_thread_specific<SeamCarver> carvers(options);
+
+  size_t suivante = 0;
+  atomic<int> nb_images(0), nb_erreurs(0);
+
+  auto debut = chrono::steady_clock::now();
+  tbb::parallel_pipeline(
+      2 * tbb::this_task_arena::max_concurrency(),
+      tbb::make_filter<void, ImageSerie *>(
+          tbb::filter_mode::serial_in_order,
+          [&](tbb::flow_control &fc) -> ImageSerie * {
+            if (suivante == chemins.size()) {
+              fc.stop();
+              return nullptr;
+            }
+            ImageSerie *courante = new ImageSerie;
+            courante->chemin = chemins[suivante++];
+            return courante;
+          }) &
+          tbb::make_filter<ImageSerie *, ImageSerie *>(
+              tbb::filter_mode::parallel,
+              [&](ImageSerie *courante) {
+                PROFIL_ETAPE("imread");
+                string fichier = courante->chemin.string();
+                courante->image = imread(fichier, IMREAD_UNCHANGED);
+                if (!courante->image.empty() &&
+                    !pixelPrisEnCharge(courante->image.type())) {
+                  courante->image = imread(fichier, IMREAD_COLOR);
+                }
+                if (courante->image.empty()) {
+                  cerr << "Erreur de lecture de l'image " << fichier << "."
+                       << endl;
+                  courante->ok = false;
+                }
+                return courante;
+              }) &
+          tbb::make_filter<ImageSerie *, ImageSerie *>(
+              tbb::filter_mode::parallel,
+              [&](ImageSerie *courante) {
+                if (!courante->ok) {
+                  return courante;
+                }
+                tbb::this_task_arena::isolate([&] {
+                  SeamCarver &carver = carvers.local();
+                  Mat gris = imageGris(courante->image);
+                  size_t nb_types = seam_types.size();
+                  courante->resized.resize(nb_types);
+                  courante->seamed.resize(nb_types);
+                  for (size_t t = 0; t < nb_types && courante->ok; ++t) {
+                    Mat *p_seamed =
+                        options.image_seamed ? &courante->seamed[t] : nullptr;
+                    // Le dernier type reprend le buffer de l'image d'origine
+                    if (t + 1 == nb_types) {
+                      courante->resized[t] = carver.redimensionner(
+                          std::move(courante->image), NB_TOUR, seam_types[t],
+                          p_seamed, gris);
+                    } else {
+                      courante->resized[t] =
+                          carver.redimensionner(courante->image, NB_TOUR,
+                                                seam_types[t], p_seamed, gris);
+                    }
+                    if (courante->resized[t].empty()) {
+                      cerr << "Erreur : Image " << courante->chemin.string()
+                           << " non réduite." << endl;
+                      courante->ok = false;
+                    }
+                  }
+                  courante->image.release();
+                });
+                return courante;
+              }) &
+          tbb::make_filter<ImageSerie *, void>(
+              tbb::filter_mode::parallel, [&](ImageSerie *courante) {
+                if (courante->ok) {
+                  PROFIL_ETAPE("imwrite");
+                  string nom = courante->chemin.filename().string();
+                  string repertoire = string("Images/") +
+                                      courante->chemin.stem().string() + "/";
+                  error_code ec;
+                  filesystem::create_directories(repertoire, ec);
+                  for (size_t t = 0; t < seam_types.size(); ++t) {
+                    string suffixe = (seam_types[t] == SEAM_ROWS)   ? "rows-"
+                                     : (seam_types[t] == SEAM_COLS) ? "cols-"
+                                                                    : "both-";
+                    string fichier = repertoire + "resized_" + suffixe + nom;
+                    bool ecrit = imwrite(fichier, courante->resized[t]);
+                    if (ecrit && options.image_seamed) {
+                      fichier = repertoire + "seamed_" + suffixe + nom;
+                      ecrit = imwrite(fichier, courante->seamed[t]);
+                    }
+                    if (!ecrit) {
+                      cerr << "Erreur d'écriture de l'image " << fichier
+                           << "." << endl;
+                      courante->ok = false;
+                      break;
+                    }
+                  }
+                }
+                if (courante->ok) {
+                  ++nb_images;
+                } else {
+                  ++nb_erreurs;
+                }
+                delete courante;
+              }));
+
+  double duree =
+      chrono::duration<double>(chrono::steady_clock::now() - debut).count();
+  cout << nb_images << " images réduites en " << duree << " s ("
+       << nb_images / duree << " images/s)";
+  if (nb_erreurs > 0) {
+    cout << ", " << nb_erreurs << " en erreur";
+  }
+  cout << endl;
+  if (nb_images > 0) {
+    cout << "Images resized enregistrées: Images/<nom>/resized_*" << endl;
+  }
+
+  return nb_images > 0 ? nb_images.load() : -1;
+} // Fin seamCarvingSerie
@@ -0,0 +1,22 @@
+#ifndef SERIE_H
+#define SERIE_H
+
+#include <string>
+#include <vector>
+
+#include "seamcarving.h"
+
+/**
+ * Seam carving d'une série d'images indépendantes, en un seul processus.
+ *
+ * Les images viennent d'un répertoire ou d'un fichier liste (un chemin par
+ * ligne). Lecture, carving et écriture s'enchaînent dans un pipeline TBB
+ * borné : plusieurs images sont en vol à la fois, chacune décodée une seule
+ * fois, et l'encodage des unes recouvre le carving des autres.
+ */
+
+int seamCarvingSerie(const std::string &source, int NB_TOUR,
+                     const std::vector<int> &seam_types,
+                     const SeamOptions &options = SeamOptions());
+
+#endif
@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <poll.h>
+#include <set>
+#include <string>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <tbb/task_arena.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "profil.h"
+#include "seamcarver.h"
+#include "seamcarving.h"
+#include "serveur.h"
+
+using namespace cv;
+using namespace std;
+
+// Demande d'arrêt (SIGINT, SIGTERM)
+static volatile sig_atomic_t arret_demande = 0;
+
+static void demanderArret(int) { arret_demande = 1; }
+
+/**
+ * SeamCarver libres, gardés d'une requête à l'autre avec leur espace de
+ * travail. Il y en a au plus autant que de requêtes traitées à la fois.
+ */
+struct ReserveCarvers {
+  SeamOptions options;
+  mutex verrou;
+  vector<unique_ptr<SeamCarver>> libres;
+
+  unique_ptr<SeamCarver> prendre() {
+    lock_guard<mutex> garde(verrou);
+    if (libres.empty()) {
+      return make_unique<SeamCarver>(options);
+    }
+    unique_ptr<SeamCarver> carver = std::move(libres.back());
+    libres.pop_back();
+    return carver;
+  }
+
+  void rendre(unique_ptr<SeamCarver> carver) {
+    lock_guard<mutex> garde(verrou);
+    libres.push_back(std::move(carver));
+  }
+};
+
+/**
+ * Connexions en cours, pour les interrompre et les attendre à l'arrêt.
+ */
+struct Connexions {
+  mutex verrou;
+  condition_variable terminee;
+  set<int> ouvertes;
+};
+
+/**
+ * Lit exactement taille octets, en reprenant après un signal.
+ *
+ * @param fd Descripteur lu
+ * @param buffer Reçoit les octets
+ * @param taille Nombre d'octets à lire
+ * @return 1 si tout est lu, 0 si le flux se termine avant le premier octet,
+ * -1 en cas d'erreur ou de flux tronqué
+ */
+static int lireTout(int fd, void *buffer, size_t taille) {
+  char *courant = static_cast<char *>(buffer);
+  size_t lus = 0;
+  while (lus < taille) {
+    ssize_t n = read(fd, courant + lus, taille - lus);
+    if (n < 0 && errno == EINTR && !arret_demande) {
+      continue;
+    }
+    if (n <= 0) {
+      return (n == 0 && lus == 0) ? 0 : -1;
+    }
+    lus += n;
+  }
+  return 1;
+} // Fin lireTout
+
+/**
+ * Écrit exactement taille octets, en reprenant après un signal.
+ *
+ * @param fd Descripteur écrit
+ * @param buffer Octets à écrire
+ * @param taille Nombre d'octets
+ * @return false en cas d'erreur (client parti)
+ */
+static bool ecrireTout(int fd, const void *buffer, size_t taille) {
+  const char *courant = static_cast<const char *>(buffer);
+  size_t ecrits = 0;
+  while (ecrits < taille) {
+    ssize_t n = write(fd, courant + ecrits, taille - ecrits);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    ecrits += n;
+  }
+  return true;
+} // Fin ecrireTout
+
+/**
+ * Envoie une réponse : en-tête puis blocs, chacun précédé de sa taille.
+ *
+ * @param fd Descripteur de sortie
+ * @param statut 0 si les blocs sont des images, -1 pour un message d'erreur
+ * @param blocs Blocs à envoyer
+ * @return false si le client est parti
+ */
+static bool envoyerReponse(int fd, int32_t statut,
+                           const vector<vector<uchar>> &blocs) {
+  uint32_t entete[3] = {SERVEUR_SIGNATURE_REPONSE, (uint32_t)statut,
+                        (uint32_t)blocs.size()};
+  if (!ecrireTout(fd, entete, sizeof(entete))) {
+    return false;
+  }
+  for (const vector<uchar> &bloc : blocs) {
+    uint32_t taille = bloc.size();
+    if (!ecrireTout(fd, &taille, sizeof(taille)) ||
+        !ecrireTout(fd, bloc.data(), bloc.size())) {
+      return false;
+    }
+  }
+  return true;
+} // Fin envoyerReponse
+
+/**
+ * Envoie une réponse d'erreur, et la note sur la sortie d'erreur.
+ *
+ * @param fd Descripteur de sortie
+ * @param message Message renvoyé au client
+ * @return false si le client est parti
+ */
+static bool envoyerErreur(int fd, const string &message) {
+  cerr << "Erreur : " << message << endl;
+  return envoyerReponse(fd, -1,
+                        {vector<uchar>(message.begin(), message.end())});
+} // Fin envoyerErreur
+
+/**
+ * Réduit une image reçue et encode les images produites.
+ *
+ * @param donnees Image encodée
+ * @param nb_seams Nombre de seams (négatif pour en insérer)
+ * @param type Type de seam, numéroté comme en ligne de commande
+ * @param seamed Vrai pour joindre les images seamed
+ * @param format Extension du format de sortie
+ * @param reserve SeamCarver disponibles
+ * @param blocs Reçoit les images encodées
+ * @param message Reçoit la cause d'un échec
+ * @return false en cas d'erreur
+ */
+static bool reduireRequete(const vector<uchar> &donnees, int nb_seams,
+                           int type, bool seamed, const string &format,
+                           ReserveCarvers &reserve,
+                           vector<vector<uchar>> &blocs, string &message) {
+  vector<int> seam_types;
+  if (type == 1 || type == 3) {
+    seam_types.push_back(SEAM_COLS);
+  }
+  if (type == 2 || type == 3) {
+    seam_types.push_back(SEAM_ROWS);
+  }
+  if (type == 4) {
+    seam_types.push_back(SEAM_BOTH);
+  }
+  if (seam_types.empty()) {
+    message = "Type de seam invalide (" + to_string(type) + ").";
+    return false;
+  }
+  if (!haveImageWriter(format)) {
+    message = "Format de sortie inconnu (" + format + ").";
+    return false;
+  }
+
+  Mat image;
+  {
+    PROFIL_ETAPE("imdecode");
+    image = imdecode(donnees, IMREAD_UNCHANGED);
+    if (!image.empty() && !pixelPrisEnCharge(image.type())) {
+      image = imdecode(donnees, IMREAD_COLOR);
+    }
+  }
+  if (image.empty()) {
+    message = "Image illisible.";
+    return false;
+  }
+  // Mêmes bornes que SeamCarver::redimensionner, vérifiées ici pour que le
+  // client en reçoive la cause
+  for (int seam_type : seam_types) {
+    int dimension = (seam_type == SEAM_COLS)   ? image.cols
+                    : (seam_type == SEAM_ROWS) ? image.rows
+                                               : min(image.rows, image.cols);
+    int minimum = (seam_type == SEAM_BOTH) ? 0 : 1 - dimension;
+    if (nb_seams < minimum || nb_seams >= dimension) {
+      message = "Nombre de seams invalide (" + to_string(nb_seams) +
+                ") pour une image " + to_string(image.cols) + "x" +
+                to_string(image.rows) + ".";
+      return false;
+    }
+  }
+  Mat gris = imageGris(image);
+
+  unique_ptr<SeamCarver> carver = reserve.prendre();
+  vector<Mat> images;
+  for (int seam_type : seam_types) {
+    Mat img_seamed;
+    Mat resized = carver->redimensionner(
+        image, nb_seams, seam_type, seamed ? &img_seamed : nullptr, gris);
+    if (resized.empty()) {
+      break;
+    }
+    images.push_back(resized);
+    if (seamed) {
+      images.push_back(img_seamed);
+    }
+  }
+  reserve.rendre(std::move(carver));
+  if (images.size() != seam_types.size() * (seamed ? 2 : 1)) {
+    message = "Image non réduite.";
+    return false;
+  }
+
+  PROFIL_ETAPE("imencode");
+  blocs.resize(images.size());
+  for (size_t i = 0; i < images.size(); ++i) {
+    if (!imencode(format, images[i], blocs[i])) {
+      message = "Échec de l'encodage en " + format + ".";
+      return false;
+    }
+  }
+  return true;
+} // Fin reduireRequete
+
+/**
+ * Sert les requêtes d'un client, l'une après l'autre, jusqu'à ce qu'il ferme
+ * le flux. Un en-tête invalide met fin à la connexion, le flux ne pouvant
+ * plus être suivi ; une image qui ne peut pas être réduite ne renvoie qu'une
+ * erreur.
+ *
+ * @param entree Descripteur des requêtes
+ * @param sortie Descripteur des réponses
+ * @param reserve SeamCarver disponibles
+ * @param arene Arène où se fait le carving
+ * @param nb_requetes Compteur des requêtes servies
+ */
+static void servir(int entree, int sortie, ReserveCarvers &reserve,
+                   tbb::task_arena &arene, atomic<int> &nb_requetes) {
+  vector<uchar> donnees;
+  while (!arret_demande) {
+    uint32_t entete[6];
+    char format[9] = {};
+    int lu = lireTout(entree, entete, sizeof(entete));
+    if (lu == 0) {
+      return;
+    }
+    if (lu < 0 || lireTout(entree, format, 8) < 0) {
+      cerr << "Erreur : Requête tronquée." << endl;
+      return;
+    }
+    if (entete[0] != SERVEUR_SIGNATURE_REQUETE ||
+        entete[1] != SERVEUR_VERSION) {
+      envoyerErreur(sortie, "En-tête de requête invalide.");
+      return;
+    }
+    if (entete[5] > SERVEUR_TAILLE_MAX) {
+      envoyerErreur(sortie, "Image trop grande (" + to_string(entete[5]) +
+                                " octets).");
+      return;
+    }
+    donnees.resize(entete[5]);
+    if (!donnees.empty() &&
+        lireTout(entree, donnees.data(), donnees.size()) <= 0) {
+      cerr << "Erreur : Requête tronquée." << endl;
+      return;
+    }
+
+    int nb_seams = (int32_t)entete[2];
+    int type = (int32_t)entete[3];
+    bool seamed = entete[4] & 1;
+    string extension = format[0] ? format : ".png";
+
+    vector<vector<uchar>> blocs;
+    string message;
+    bool ok = arene.execute([&] {
+      return reduireRequete(donnees, nb_seams, type, seamed, extension,
+                            reserve, blocs, message);
+    });
+    bool envoye = ok ? envoyerReponse(sortie, 0, blocs)
+                     : envoyerErreur(sortie, message);
+    if (!envoye) {
+      cerr << "Erreur : Client déconnecté." << endl;
+      return;
+    }
+    ++nb_requetes;
+  }
+} // Fin servir
+
+/**
+ * Ouvre la socket Unix d'écoute, en remplaçant une socket laissée par un
+ * serveur précédent.
+ *
+ * @param chemin Chemin de la socket
+ * @return Descripteur de la socket, -1 en cas d'erreur
+ */
+static int ouvrirSocket(const string &chemin) {
+  sockaddr_un adresse = {};
+  adresse.sun_family = AF_UNIX;
+  if (chemin.size() >= sizeof(adresse.sun_path)) {
+    cerr << "Erreur : Chemin de socket trop long (" << chemin << ")." << endl;
+    return -1;
+  }
+  strcpy(adresse.sun_path, chemin.c_str());
+
+  int ecoute = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (ecoute < 0) {
+    perror("socket");
+    return -1;
+  }
+  unlink(chemin.c_str());
+  if (bind(ecoute, (sockaddr *)&adresse, sizeof(adresse)) < 0 ||
+      listen(ecoute, SOMAXCONN) < 0) {
+    perror(chemin.c_str());
+    close(ecoute);
+    return -1;
+  }
+  return ecoute;
+} // Fin ouvrirSocket
+
+/**
+ * Serveur de seam carving : sert les requêtes jusqu'à SIGINT ou SIGTERM
+ * (socket Unix) ou jusqu'à la fin de l'entrée standard ("-").
+ *
+ * Sur la socket, chaque client a son thread ; les requêtes de clients
+ * différents sont carvées en même temps dans l'arène, et celles d'un même
+ * client dans l'ordre. À l'arrêt, les connexions en cours sont coupées après
+ * la requête en cours, et la socket est supprimée. La sortie standard ne
+ * porte que les réponses : les messages vont sur la sortie d'erreur.
+ *
+ * @param chemin Chemin de la socket Unix, ou "-" pour l'entrée et la sortie
+ * standard
+ * @param options Options du seam carving (ni index, ni comparaison)
+ * @param arene Arène où se fait le carving ; le serveur attend les clients
+ * hors de l'arène, pour n'y occuper aucune place
+ * @return Nombre de requêtes servies, -1 si le serveur n'a pas pu démarrer
+ */
+int seamCarvingServeur(const string &chemin, const SeamOptions &options,
+                       tbb::task_arena &arene) {
+  if (options.creer_index || options.depuis_index || options.comparer) {
+    cerr << "Erreur : Le serveur ne prend ni index, ni comparaison." << endl;
+    return -1;
+  }
+
+  ReserveCarvers reserve;
+  reserve.options = options;
+  atomic<int> nb_requetes(0);
+
+  // Un client parti ne doit pas arrêter le serveur
+  signal(SIGPIPE, SIG_IGN);
+
+  if (chemin == "-") {
+    servir(STDIN_FILENO, STDOUT_FILENO, reserve, arene, nb_requetes);
+    cerr << nb_requetes << " requêtes servies." << endl;
+    return nb_requetes;
+  }
+
+  int ecoute = ouvrirSocket(chemin);
+  if (ecoute < 0) {
+    return -1;
+  }
+
+  // Sans SA_RESTART : poll s'interrompt au signal
+  struct sigaction action = {};
+  action.sa_handler = demanderArret;
+  sigemptyset(&action.sa_mask);
+  sigaction(SIGINT, &action, nullptr);
+  sigaction(SIGTERM, &action, nullptr);
+
+  cerr << "Serveur à l'écoute sur " << chemin << "." << endl;
+
+  Connexions connexions;
+  while (!arret_demande) {
+    // Le signal peut arriver à un autre thread : poll se réveille
+    // régulièrement pour le voir
+    pollfd attente = {ecoute, POLLIN, 0};
+    int pret = poll(&attente, 1, 200);
+    if (pret < 0 && errno != EINTR) {
+      perror("poll");
+      break;
+    }
+    if (pret <= 0) {
+      continue;
+    }
+    int client = accept(ecoute, nullptr, nullptr);
+    if (client < 0) {
+      if (errno != EINTR && errno != ECONNABORTED) {
+        perror("accept");
+      }
+      continue;
+    }
+    {
+      lock_guard<mutex> garde(connexions.verrou);
+      connexions.ouvertes.insert(client);
+    }
+    thread([client, &connexions, &reserve, &arene, &nb_requetes] {
+      servir(client, client, reserve, arene, nb_requetes);
+      lock_guard<mutex> garde(connexions.verrou);
+      connexions.ouvertes.erase(client);
+      close(client);
+      connexions.terminee.notify_all();
+    }).detach();
+  }
+
+  close(ecoute);
+  unlink(chemin.c_str());
+
+  // Les clients en attente de lecture sont coupés, ceux en cours de carving
+  // finissent leur requête
+  unique_lock<mutex> verrou(connexions.verrou);
+  for (int client : connexions.ouvertes) {
+    shutdown(client, SHUT_RDWR);
+  }
+  connexions.terminee.wait(verrou, [&] { return connexions.ouvertes.empty(); });
+
+  cerr << nb_requetes << " requêtes servies." << endl;
+  return nb_requetes;
+} // Fin seamCarvingServeur
@@ -0,0 +1,33 @@
+#ifndef SERVEUR_H
+#define SERVEUR_H
+
+#include <string>
+#include <tbb/task_arena.h>
+
+#include "seamcarving.h"
+
+/**
+ * Serveur de seam carving résident.
+ *
+ * Les images arrivent encodées sur une socket Unix (une connexion par
+ * client, servie par son propre thread) ou sur l'entrée standard, et
+ * repartent encodées, sans passer par le disque. Les threads TBB et les
+ * SeamCarver, avec leur espace de travail déjà dimensionné, restent prêts
+ * d'une requête à l'autre.
+ *
+ * Requête : six entiers 32 bits dans l'ordre de la machine (signature
+ * SERVEUR_SIGNATURE_REQUETE, version SERVEUR_VERSION, nombre de seams, type
+ * de seam comme en ligne de commande de 1 à 4, drapeaux dont le bit 0
+ * demande les images seamed, taille de l'image), l'extension du format de
+ * sortie sur 8 octets (".png" si vide), puis l'image encodée.
+ *
+ * Réponse : trois entiers 32 bits (signature SERVEUR_SIGNATURE_REPONSE,
+ * statut 0 ou -1, nombre de blocs), suivis des blocs, chacun précédé de sa
+ * taille : les images resized, chacune suivie de son image seamed si elle
+ * est demandée, ou le message d'erreur.
+ */
+
+int seamCarvingServeur(const std::string &chemin, const SeamOptions &options,
+                       tbb::task_arena &arene);
+
+#endif
@@ -0,0 +1,591 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIMD_X86 1
+#endif
+
+#include "simd.h"
+
+using namespace std;
+
+typedef void (*LigneFn)(const int *, const unsigned char *, int *, int, int,
+                        int);
+typedef int (*ArgminFn)(const int *, int);
+typedef void (*FlouFn)(const unsigned char *, const unsigned char *,
+                       const unsigned char *, unsigned char *, int, int);
+typedef void (*MagnitudeFn)(const unsigned char *, const unsigned char *,
+                            const unsigned char *, float *, int, int);
+typedef void (*DirectionsFn)(const int *, unsigned char *, int);
+
+/**
+ * Calcule les bords d'une portion de ligne de la matrice cumulative et
+ * réduit [debut, fin) à l'intérieur de la ligne, où les trois voisins du
+ * dessus existent toujours.
+ *
+ * @param prec Ligne précédente de la matrice cumulative
+ * @param energie Ligne d'énergie courante
+ * @param courant Ligne courante de la matrice cumulative
+ * @param debut Première colonne à calculer, ramenée au début de l'intérieur
+ * @param fin Colonne de fin (exclue), ramenée à la fin de l'intérieur
+ * @param cols Largeur de la ligne
+ */
+static inline void bordsLigne(const int *prec, const unsigned char *energie,
+                              int *courant, int &debut, int &fin, int cols) {
+  if (debut >= fin) {
+    return;
+  }
+
+  // Première colonne : pas de voisin à gauche
+  if (debut == 0) {
+    int min_prev = (cols > 1) ? min(prec[0], prec[1]) : prec[0];
+    courant[0] = energie[0] + min_prev;
+    debut = 1;
+  }
+
+  // Dernière colonne : pas de voisin à droite
+  if (fin == cols && debut < fin) {
+    courant[cols - 1] = energie[cols - 1] + min(prec[cols - 2], prec[cols - 1]);
+    fin = cols - 1;
+  }
+} // Fin bordsLigne
+
+/**
+ * Version générique de la mise à jour d'une ligne : sans branchement à
+ * l'intérieur de la ligne, la boucle est vectorisée par le compilateur
+ * (SSE2, NEON...).
+ */
+static void ligneGenerique(const int *prec, const unsigned char *energie,
+                           int *courant, int debut, int fin, int cols) {
+  bordsLigne(prec, energie, courant, debut, fin, cols);
+
+  for (int j = debut; j < fin; ++j) {
+    courant[j] = energie[j] + min(min(prec[j - 1], prec[j]), prec[j + 1]);
+  }
+} // Fin ligneGenerique
+
+/**
+ * Indice du premier minimum, version générique.
+ */
+static int argminGenerique(const int *valeurs, int n) {
+  int min_idx = 0;
+  int min_val = INT_MAX;
+
+  for (int j = 0; j < n; ++j) {
+    if (valeurs[j] < min_val) {
+      min_val = valeurs[j];
+      min_idx = j;
+    }
+  }
+
+  return min_idx;
+} // Fin argminGenerique
+
+/**
+ * Flou gaussien 3x3 d'une ligne, version générique.
+ */
+static void flouGenerique(const unsigned char *haut, const unsigned char *milieu,
+                          const unsigned char *bas, unsigned char *sortie,
+                          int debut, int fin) {
+  for (int x = debut; x < fin; ++x) {
+    int som = 1 + haut[x - 1] + 2 * haut[x] + haut[x + 1] +
+              2 * (milieu[x - 1] + 2 * milieu[x] + milieu[x + 1]) +
+              bas[x - 1] + 2 * bas[x] + bas[x + 1];
+    sortie[x] = (unsigned char)(som / 16);
+  }
+} // Fin flouGenerique
+
+/**
+ * Magnitude du gradient d'une ligne, version générique.
+ */
+static void magnitudeGenerique(const unsigned char *haut,
+                               const unsigned char *milieu,
+                               const unsigned char *bas, float *sortie,
+                               int debut, int fin) {
+  for (int x = debut; x < fin; ++x) {
+    int gx = milieu[x + 1] - milieu[x - 1];
+    int gy = bas[x] - haut[x];
+    sortie[x] = sqrt((float)(gx * gx + gy * gy));
+  }
+} // Fin magnitudeGenerique
+
+/**
+ * Directions de remontée de l'octet o d'une ligne : colonnes 4 * o à
+ * 4 * o + 3, 2 bits chacune (0 : même colonne, 1 : gauche, 2 : droite, les
+ * codes DIRECTION_* de seamcarving.h).
+ */
+static inline unsigned char directionsOctet(const int *prec, int o, int cols) {
+  unsigned char octet = 0;
+  int fin = min(4 * o + 4, cols);
+  for (int j = 4 * o, b = 0; j < fin; ++j, b += 2) {
+    int direction = 0;
+    int min_val = prec[j];
+    if (j > 0 && prec[j - 1] < min_val) {
+      min_val = prec[j - 1];
+      direction = 1;
+    }
+    if (j < cols - 1 && prec[j + 1] < min_val) {
+      direction = 2;
+    }
+    octet |= (unsigned char)(direction << b);
+  }
+  return octet;
+} // Fin directionsOctet
+
+/**
+ * Directions de remontée d'une ligne, version générique.
+ */
+static void directionsGenerique(const int *prec, unsigned char *sortie,
+                                int cols) {
+  int nb_octets = (cols + 3) / 4;
+  for (int o = 0; o < nb_octets; ++o) {
+    sortie[o] = directionsOctet(prec, o, cols);
+  }
+} // Fin directionsGenerique
+
+/**
+ * Écarte les 8 bits bas d'un masque sur les bits pairs : le bit k passe au
+ * bit 2k.
+ */
+static inline unsigned int etalerBits(unsigned int masque) {
+  masque = (masque | (masque << 4)) & 0x0F0Fu;
+  masque = (masque | (masque << 2)) & 0x3333u;
+  masque = (masque | (masque << 1)) & 0x5555u;
+  return masque;
+} // Fin etalerBits
+
+#ifdef SIMD_X86
+
+/**
+ * Mise à jour d'une ligne en AVX2 : 8 cases par itération, à partir de trois
+ * chargements décalés de la ligne précédente.
+ */
+__attribute__((target("avx2"))) static void
+ligneAvx2(const int *prec, const unsigned char *energie, int *courant,
+          int debut, int fin, int cols) {
+  bordsLigne(prec, energie, courant, debut, fin, cols);
+
+  int j = debut;
+  for (; j + 8 <= fin; j += 8) {
+    __m256i gauche = _mm256_loadu_si256((const __m256i *)(prec + j - 1));
+    __m256i milieu = _mm256_loadu_si256((const __m256i *)(prec + j));
+    __m256i droite = _mm256_loadu_si256((const __m256i *)(prec + j + 1));
+    __m256i min_prev =
+        _mm256_min_epi32(_mm256_min_epi32(gauche, milieu), droite);
+    __m256i e =
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(energie + j)));
+    _mm256_storeu_si256((__m256i *)(courant + j),
+                        _mm256_add_epi32(min_prev, e));
+  }
+
+  for (; j < fin; ++j) {
+    courant[j] = energie[j] + min(min(prec[j - 1], prec[j]), prec[j + 1]);
+  }
+} // Fin ligneAvx2
+
+/**
+ * Mise à jour d'une ligne en SSE4.1 : 4 cases par itération.
+ */
+__attribute__((target("sse4.1"))) static void
+ligneSse41(const int *prec, const unsigned char *energie, int *courant,
+           int debut, int fin, int cols) {
+  bordsLigne(prec, energie, courant, debut, fin, cols);
+
+  int j = debut;
+  for (; j + 4 <= fin; j += 4) {
+    __m128i gauche = _mm_loadu_si128((const __m128i *)(prec + j - 1));
+    __m128i milieu = _mm_loadu_si128((const __m128i *)(prec + j));
+    __m128i droite = _mm_loadu_si128((const __m128i *)(prec + j + 1));
+    __m128i min_prev = _mm_min_epi32(_mm_min_epi32(gauche, milieu), droite);
+    int quatre;
+    memcpy(&quatre, energie + j, sizeof(int));
+    __m128i e = _mm_cvtepu8_epi32(_mm_cvtsi32_si128(quatre));
+    _mm_storeu_si128((__m128i *)(courant + j), _mm_add_epi32(min_prev, e));
+  }
+
+  for (; j < fin; ++j) {
+    courant[j] = energie[j] + min(min(prec[j - 1], prec[j]), prec[j + 1]);
+  }
+} // Fin ligneSse41
+
+/**
+ * Indice du premier minimum en AVX2 : une passe pour la valeur minimale,
+ * puis une recherche de sa première occurrence.
+ */
+__attribute__((target("avx2"))) static int argminAvx2(const int *valeurs,
+                                                      int n) {
+  if (n < 16) {
+    return argminGenerique(valeurs, n);
+  }
+
+  // Étape 1 : valeur minimale
+  __m256i vmin = _mm256_set1_epi32(INT_MAX);
+  int j = 0;
+  for (; j + 8 <= n; j += 8) {
+    vmin = _mm256_min_epi32(
+        vmin, _mm256_loadu_si256((const __m256i *)(valeurs + j)));
+  }
+  __m128i m = _mm_min_epi32(_mm256_castsi256_si128(vmin),
+                            _mm256_extracti128_si256(vmin, 1));
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(1, 0, 3, 2)));
+  m = _mm_min_epi32(m, _mm_shuffle_epi32(m, _MM_SHUFFLE(2, 3, 0, 1)));
+  int min_val = _mm_cvtsi128_si32(m);
+  for (; j < n; ++j) {
+    min_val = min(min_val, valeurs[j]);
+  }
+
+  // Étape 2 : première occurrence
+  __m256i cible = _mm256_set1_epi32(min_val);
+  for (j = 0; j + 8 <= n; j += 8) {
+    __m256i egal = _mm256_cmpeq_epi32(
+        _mm256_loadu_si256((const __m256i *)(valeurs + j)), cible);
+    int masque = _mm256_movemask_ps(_mm256_castsi256_ps(egal));
+    if (masque) {
+      return j + __builtin_ctz(masque);
+    }
+  }
+  for (; j < n; ++j) {
+    if (valeurs[j] == min_val) {
+      return j;
+    }
+  }
+
+  return 0;
+} // Fin argminAvx2
+
+/**
+ * Indice du premier minimum en SSE4.1.
+ */
+__attribute__((target("sse4.1"))) static int argminSse41(const int *valeurs,
+                                                        int n) {
+  if (n < 8) {
+    return argminGenerique(valeurs, n);
+  }
+
+  // Étape 1 : valeur minimale
+  __m128i vmin = _mm_set1_epi32(INT_MAX);
+  int j = 0;
+  for (; j + 4 <= n; j += 4) {
+    vmin = _mm_min_epi32(vmin, _mm_loadu_si128((const __m128i *)(valeurs + j)));
+  }
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+  vmin = _mm_min_epi32(vmin, _mm_shuffle_epi32(vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+  int min_val = _mm_cvtsi128_si32(vmin);
+  for (; j < n; ++j) {
+    min_val = min(min_val, valeurs[j]);
+  }
+
+  // Étape 2 : première occurrence
+  __m128i cible = _mm_set1_epi32(min_val);
+  for (j = 0; j + 4 <= n; j += 4) {
+    __m128i egal =
+        _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)(valeurs + j)), cible);
+    int masque = _mm_movemask_ps(_mm_castsi128_ps(egal));
+    if (masque) {
+      return j + __builtin_ctz(masque);
+    }
+  }
+  for (; j < n; ++j) {
+    if (valeurs[j] == min_val) {
+      return j;
+    }
+  }
+
+  return 0;
+} // Fin argminSse41
+
+/**
+ * Flou gaussien 3x3 d'une ligne en AVX2 : 16 pixels par itération, sommes
+ * sur 16 bits (au plus 16 * 255 + 1).
+ */
+__attribute__((target("avx2"))) static void
+flouAvx2(const unsigned char *haut, const unsigned char *milieu,
+         const unsigned char *bas, unsigned char *sortie, int debut,
+         int fin) {
+  const unsigned char *lignes[3] = {haut, milieu, bas};
+  const __m256i un = _mm256_set1_epi16(1);
+
+  int x = debut;
+  for (; x + 16 <= fin; x += 16) {
+    __m256i h[3];
+    for (int l = 0; l < 3; ++l) {
+      const __m128i *p = (const __m128i *)(lignes[l] + x);
+      __m256i g = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128((const __m128i *)(lignes[l] + x - 1)));
+      __m256i c = _mm256_cvtepu8_epi16(_mm_loadu_si128(p));
+      __m256i d = _mm256_cvtepu8_epi16(
+          _mm_loadu_si128((const __m128i *)(lignes[l] + x + 1)));
+      h[l] = _mm256_add_epi16(_mm256_add_epi16(g, d), _mm256_add_epi16(c, c));
+    }
+    __m256i som = _mm256_add_epi16(_mm256_add_epi16(h[0], h[2]),
+                                   _mm256_add_epi16(h[1], h[1]));
+    som = _mm256_srli_epi16(_mm256_add_epi16(som, un), 4);
+
+    // Repassage sur 8 bits : packus travaille par moitié de registre
+    __m256i octets = _mm256_permute4x64_epi64(_mm256_packus_epi16(som, som),
+                                              _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storeu_si128((__m128i *)(sortie + x), _mm256_castsi256_si128(octets));
+  }
+
+  flouGenerique(haut, milieu, bas, sortie, x, fin);
+} // Fin flouAvx2
+
+/**
+ * Magnitude du gradient d'une ligne en AVX2 : 8 pixels par itération. Les
+ * sommes de carrés sont entières, donc exactes en float comme en scalaire.
+ */
+__attribute__((target("avx2"))) static void
+magnitudeAvx2(const unsigned char *haut, const unsigned char *milieu,
+              const unsigned char *bas, float *sortie, int debut, int fin) {
+  int x = debut;
+  for (; x + 8 <= fin; x += 8) {
+    __m256i gauche = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64((const __m128i *)(milieu + x - 1)));
+    __m256i droite = _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64((const __m128i *)(milieu + x + 1)));
+    __m256i dessus =
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(haut + x)));
+    __m256i dessous =
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(bas + x)));
+    __m256i gx = _mm256_sub_epi32(droite, gauche);
+    __m256i gy = _mm256_sub_epi32(dessous, dessus);
+    __m256i carres =
+        _mm256_add_epi32(_mm256_mullo_epi32(gx, gx), _mm256_mullo_epi32(gy, gy));
+    _mm256_storeu_ps(sortie + x, _mm256_sqrt_ps(_mm256_cvtepi32_ps(carres)));
+  }
+
+  magnitudeGenerique(haut, milieu, bas, sortie, x, fin);
+} // Fin magnitudeAvx2
+
+/**
+ * Directions de remontée d'une ligne en AVX2 : 8 colonnes (2 octets) par
+ * itération. La gauche gagne si elle est strictement plus petite que le
+ * centre, la droite si elle est strictement plus petite que les deux.
+ */
+__attribute__((target("avx2"))) static void
+directionsAvx2(const int *prec, unsigned char *sortie, int cols) {
+  int nb_octets = (cols + 3) / 4;
+  if (nb_octets == 0) {
+    return;
+  }
+
+  // Premier octet à part : la colonne 0 n'a pas de voisin à gauche
+  sortie[0] = directionsOctet(prec, 0, cols);
+  int o = 1;
+  for (; 4 * o + 9 <= cols; o += 2) {
+    const int *p = prec + 4 * o;
+    __m256i gauche = _mm256_loadu_si256((const __m256i *)(p - 1));
+    __m256i milieu = _mm256_loadu_si256((const __m256i *)p);
+    __m256i droite = _mm256_loadu_si256((const __m256i *)(p + 1));
+    __m256i vers_gauche = _mm256_cmpgt_epi32(milieu, gauche);
+    __m256i vers_droite =
+        _mm256_cmpgt_epi32(_mm256_min_epi32(milieu, gauche), droite);
+    unsigned int masque_g = _mm256_movemask_ps(
+        _mm256_castsi256_ps(_mm256_andnot_si256(vers_droite, vers_gauche)));
+    unsigned int masque_d =
+        _mm256_movemask_ps(_mm256_castsi256_ps(vers_droite));
+    unsigned int codes = etalerBits(masque_g) | (etalerBits(masque_d) << 1);
+    sortie[o] = (unsigned char)codes;
+    sortie[o + 1] = (unsigned char)(codes >> 8);
+  }
+
+  for (; o < nb_octets; ++o) {
+    sortie[o] = directionsOctet(prec, o, cols);
+  }
+} // Fin directionsAvx2
+
+/**
+ * Directions de remontée d'une ligne en SSE4.1 : 4 colonnes (1 octet) par
+ * itération.
+ */
+__attribute__((target("sse4.1"))) static void
+directionsSse41(const int *prec, unsigned char *sortie, int cols) {
+  int nb_octets = (cols + 3) / 4;
+  if (nb_octets == 0) {
+    return;
+  }
+
+  sortie[0] = directionsOctet(prec, 0, cols);
+  int o = 1;
+  for (; 4 * o + 5 <= cols; ++o) {
+    const int *p = prec + 4 * o;
+    __m128i gauche = _mm_loadu_si128((const __m128i *)(p - 1));
+    __m128i milieu = _mm_loadu_si128((const __m128i *)p);
+    __m128i droite = _mm_loadu_si128((const __m128i *)(p + 1));
+    __m128i vers_gauche = _mm_cmpgt_epi32(milieu, gauche);
+    __m128i vers_droite =
+        _mm_cmpgt_epi32(_mm_min_epi32(milieu, gauche), droite);
+    unsigned int masque_g = _mm_movemask_ps(
+        _mm_castsi128_ps(_mm_andnot_si128(vers_droite, vers_gauche)));
+    unsigned int masque_d = _mm_movemask_ps(_mm_castsi128_ps(vers_droite));
+    sortie[o] =
+        (unsigned char)(etalerBits(masque_g) | (etalerBits(masque_d) << 1));
+  }
+
+  for (; o < nb_octets; ++o) {
+    sortie[o] = directionsOctet(prec, o, cols);
+  }
+} // Fin directionsSse41
+
+#endif // SIMD_X86
+
+/**
+ * Choix de l'implémentation, fait une seule fois.
+ *
+ * @return 2 pour AVX2, 1 pour SSE4.1, 0 pour la version générique
+ */
+static int niveauSimd() {
+  static const int niveau = [] {
+    const char *force = getenv("SEAM_SIMD");
+    int max_niveau = 0;
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+      max_niveau = 2;
+    } else if (__builtin_cpu_supports("sse4.1")) {
+      max_niveau = 1;
+    }
+#endif
+    if (force) {
+      string choix = force;
+      int demande = (choix == "avx2") ? 2 : (choix == "sse41") ? 1 : 0;
+      return min(demande, max_niveau);
+    }
+    return max_niveau;
+  }();
+
+  return niveau;
+} // Fin niveauSimd
+
+/**
+ * Calcule courant[j] = energie[j] + min(prec[j - 1], prec[j], prec[j + 1])
+ * pour j dans [debut, fin), les voisins hors de la ligne étant ignorés.
+ *
+ * @param prec Ligne précédente de la matrice cumulative
+ * @param energie Ligne d'énergie courante
+ * @param courant Ligne courante de la matrice cumulative
+ * @param debut Première colonne à calculer
+ * @param fin Colonne de fin (exclue)
+ * @param cols Largeur de la ligne
+ */
+void ligneCumulativeSimd(const int *prec, const unsigned char *energie,
+                         int *courant, int debut, int fin, int cols) {
+  static const LigneFn fonctions[3] = {
+#ifdef SIMD_X86
+      ligneGenerique, ligneSse41, ligneAvx2
+#else
+      ligneGenerique, ligneGenerique, ligneGenerique
+#endif
+  };
+
+  fonctions[niveauSimd()](prec, energie, courant, debut, fin, cols);
+} // Fin ligneCumulativeSimd
+
+/**
+ * Indice de la première occurrence de la valeur minimale.
+ *
+ * @param valeurs Tableau de valeurs
+ * @param n Nombre de valeurs (au moins 1)
+ * @return Indice du minimum
+ */
+int argminSimd(const int *valeurs, int n) {
+  static const ArgminFn fonctions[3] = {
+#ifdef SIMD_X86
+      argminGenerique, argminSse41, argminAvx2
+#else
+      argminGenerique, argminGenerique, argminGenerique
+#endif
+  };
+
+  return fonctions[niveauSimd()](valeurs, n);
+} // Fin argminSimd
+
+/**
+ * Flou gaussien 3x3 (noyau 1 2 1 / 2 4 2 / 1 2 1, arrondi comme
+ * filtreGaussien) des pixels [debut, fin) d'une ligne. Les pixels voisins
+ * doivent exister : 1 <= debut et fin <= largeur - 1.
+ *
+ * @param haut Ligne du dessus dans l'image source
+ * @param milieu Ligne courante dans l'image source
+ * @param bas Ligne du dessous dans l'image source
+ * @param sortie Ligne floutée
+ * @param debut Premier pixel à calculer
+ * @param fin Pixel de fin (exclu)
+ */
+void flouLigneSimd(const unsigned char *haut, const unsigned char *milieu,
+                   const unsigned char *bas, unsigned char *sortie, int debut,
+                   int fin) {
+  static const FlouFn fonctions[3] = {
+#ifdef SIMD_X86
+      flouGenerique, flouGenerique, flouAvx2
+#else
+      flouGenerique, flouGenerique, flouGenerique
+#endif
+  };
+
+  fonctions[niveauSimd()](haut, milieu, bas, sortie, debut, fin);
+} // Fin flouLigneSimd
+
+/**
+ * Magnitude du gradient (différences centrées, comme filtreGradient) des
+ * pixels [debut, fin) d'une ligne floutée. Les pixels voisins doivent
+ * exister : 1 <= debut et fin <= largeur - 1.
+ *
+ * @param haut Ligne floutée du dessus
+ * @param milieu Ligne floutée courante
+ * @param bas Ligne floutée du dessous
+ * @param sortie Magnitude (non normalisée)
+ * @param debut Premier pixel à calculer
+ * @param fin Pixel de fin (exclu)
+ */
+void magnitudeLigneSimd(const unsigned char *haut, const unsigned char *milieu,
+                        const unsigned char *bas, float *sortie, int debut,
+                        int fin) {
+  static const MagnitudeFn fonctions[3] = {
+#ifdef SIMD_X86
+      magnitudeGenerique, magnitudeGenerique, magnitudeAvx2
+#else
+      magnitudeGenerique, magnitudeGenerique, magnitudeGenerique
+#endif
+  };
+
+  fonctions[niveauSimd()](haut, milieu, bas, sortie, debut, fin);
+} // Fin magnitudeLigneSimd
+
+/**
+ * Directions de remontée d'une ligne de la matrice cumulative, sur 2 bits
+ * par colonne et 4 colonnes par octet : pour chaque colonne j, la case de la
+ * ligne précédente (j - 1, j ou j + 1) que choisirait la remontée d'un
+ * chemin, avec le même ordre de priorité en cas d'égalité (la même colonne,
+ * puis la gauche, puis la droite).
+ *
+ * @param prec Ligne précédente de la matrice cumulative
+ * @param sortie Directions de la ligne, (cols + 3) / 4 octets
+ * @param cols Nombre de colonnes
+ */
+void directionsLigneSimd(const int *prec, unsigned char *sortie, int cols) {
+  static const DirectionsFn fonctions[3] = {
+#ifdef SIMD_X86
+      directionsGenerique, directionsSse41, directionsAvx2
+#else
+      directionsGenerique, directionsGenerique, directionsGenerique
+#endif
+  };
+
+  fonctions[niveauSimd()](prec, sortie, cols);
+} // Fin directionsLigneSimd
+
+/**
+ * Nom de l'implémentation utilisée.
+ *
+ * @return "avx2", "sse41" ou "generique"
+ */
+const char *simdNiveau() {
+  static const char *noms[3] = {"generique", "sse41", "avx2"};
+  return noms[niveauSimd()];
+} // Fin simdNiveau
@@ -0,0 +1,25 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+/**
+ * Noyaux vectorisés du seam carving.
+ *
+ * L'implémentation (AVX2, SSE4.1 ou générique) est choisie une seule fois à
+ * l'exécution selon le processeur. La variable d'environnement SEAM_SIMD
+ * (avx2, sse41 ou generique) permet de forcer un choix, par exemple pour
+ * comparer les performances.
+ */
+
+void ligneCumulativeSimd(const int *prec, const unsigned char *energie,
+                         int *courant, int debut, int fin, int cols);
+int argminSimd(const int *valeurs, int n);
+void flouLigneSimd(const unsigned char *haut, const unsigned char *milieu,
+                   const unsigned char *bas, unsigned char *sortie, int debut,
+                   int fin);
+void magnitudeLigneSimd(const unsigned char *haut, const unsigned char *milieu,
+                        const unsigned char *bas, float *sortie, int debut,
+                        int fin);
+void directionsLigneSimd(const int *prec, unsigned char *sortie, int cols);
+const char *simdNiveau();
+
+#endif
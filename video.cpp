@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <tbb/parallel_pipeline.h>
+#include <tbb/task_arena.h>
+#include <vector>
+
+#include "profil.h"
+#include "seamcarving.h"
+#include "video.h"
+
+using namespace cv;
+using namespace std;
+
+/**
+ * Image de la séquence en vol dans le pipeline.
+ *
+ * image : image couleur, transposée pour les seams lignes, réduite sur place
+ * energie : carte d'énergie, dans le même sens que image
+ * nom : nom du fichier d'origine (répertoire d'images seulement)
+ */
+struct Trame {
+  Mat image;
+  Mat energie;
+  string nom;
+};
+
+/**
+ * Liste les images d'un répertoire dans l'ordre de la séquence.
+ *
+ * Les noms sont triés par longueur puis par ordre alphabétique, pour que
+ * image2 passe avant image10 même sans zéros en tête.
+ *
+ * @param repertoire Répertoire des images
+ * @return Chemins des images, dans l'ordre
+ */
+vector<filesystem::path> listerImages(const string &repertoire) {
+  static const vector<string> extensions = {".png", ".jpg", ".jpeg", ".bmp",
+                                            ".ppm", ".pgm", ".tif", ".tiff",
+                                            ".webp"};
+  vector<filesystem::path> fichiers;
+  for (const auto &entree : filesystem::directory_iterator(repertoire)) {
+    string extension = entree.path().extension().string();
+    transform(extension.begin(), extension.end(), extension.begin(),
+              [](unsigned char c) { return tolower(c); });
+    if (entree.is_regular_file() &&
+        find(extensions.begin(), extensions.end(), extension) !=
+            extensions.end()) {
+      fichiers.push_back(entree.path());
+    }
+  }
+  sort(fichiers.begin(), fichiers.end(),
+       [](const filesystem::path &a, const filesystem::path &b) {
+         string na = a.filename().string(), nb = b.filename().string();
+         return na.size() != nb.size() ? na.size() < nb.size() : na < nb;
+       });
+  return fichiers;
+} // Fin listerImages
+
+/**
+ * Seam carving d'une séquence d'images.
+ *
+ * Le pipeline compte quatre étapes :
+ *  - lecture des images, dans l'ordre ;
+ *  - calcul de l'énergie, en parallèle sur plusieurs images ;
+ *  - carving, dans l'ordre : chaque image cherche ses seams dans un couloir
+ *    autour de ceux de l'image précédente (options.largeur_couloir, 0 pour
+ *    un carving exact). La première image, et toute image qui change de
+ *    taille, est réduite exactement ;
+ *  - écriture, dans l'ordre.
+ *
+ * Les images d'un répertoire sont enregistrées une à une dans repertoire,
+ * sous leur nom préfixé de resized_cols- ou resized_rows-. Une vidéo est
+ * réécrite en Motion JPEG, à la cadence de la source.
+ *
+ * @param source Fichier vidéo ou répertoire d'images numérotées
+ * @param NB_TOUR Nombre de seams à retirer de chaque image
+ * @param seam_type Type de seam (SEAM_COLS ou SEAM_ROWS)
+ * @param repertoire Répertoire de sortie
+ * @param options Options du seam carving (seul largeur_couloir est utilisé)
+ * @return Nombre d'images traitées, -1 en cas d'erreur
+ */
+int seamCarvingVideo(const string &source, int NB_TOUR, int seam_type,
+                     const string &repertoire, const SeamOptions &options) {
+  if (seam_type != SEAM_COLS && seam_type != SEAM_ROWS) {
+    cerr << "Erreur : Type de seam invalide." << endl;
+    return -1;
+  }
+  if (NB_TOUR < 0) {
+    cerr << "Erreur : Nombre de seams invalide (" << NB_TOUR << ")." << endl;
+    return -1;
+  }
+
+  // Ouverture de la source
+  bool est_repertoire = filesystem::is_directory(source);
+  vector<filesystem::path> fichiers;
+  VideoCapture capture;
+  double cadence = 0;
+  if (est_repertoire) {
+    fichiers = listerImages(source);
+    if (fichiers.empty()) {
+      cerr << "Erreur : Aucune image dans le répertoire " << source << "."
+           << endl;
+      return -1;
+    }
+  } else {
+    if (!capture.open(source)) {
+      cerr << "Erreur de lecture de la vidéo " << source << "." << endl;
+      return -1;
+    }
+    cadence = capture.get(CAP_PROP_FPS);
+    if (cadence <= 0) {
+      cadence = 25;
+    }
+  }
+
+  string suffixe = (seam_type == SEAM_ROWS) ? "rows-" : "cols-";
+  string fichier_video = repertoire + "resized_" + suffixe +
+                         filesystem::path(source).stem().string() + ".avi";
+  VideoWriter sortie;
+
+  // État du carving, propre à l'étape séquentielle : seams de l'image
+  // précédente et espace de travail à sa taille
+  SeamWorkspace ws;
+  vector<int> seams;
+  Size taille;
+  bool couloir = false;
+
+  size_t suivante = 0;
+  int nb_images = 0;
+  atomic<bool> erreur(false);
+
+  auto debut = chrono::steady_clock::now();
+  tbb::parallel_pipeline(
+      2 * tbb::this_task_arena::max_concurrency(),
+      tbb::make_filter<void, Trame *>(
+          tbb::filter_mode::serial_in_order,
+          [&](tbb::flow_control &fc) -> Trame * {
+            PROFIL_ETAPE("lecture");
+            Mat image;
+            string nom;
+            if (est_repertoire) {
+              // Les fichiers illisibles sont ignorés
+              while (image.empty() && suivante < fichiers.size()) {
+                image = imread(fichiers[suivante].string(), IMREAD_COLOR);
+                nom = fichiers[suivante].filename().string();
+                ++suivante;
+              }
+            } else {
+              capture.read(image);
+            }
+            if (image.empty() || erreur) {
+              fc.stop();
+              return nullptr;
+            }
+            return new Trame{image, Mat(), nom};
+          }) &
+          tbb::make_filter<Trame *, Trame *>(
+              tbb::filter_mode::parallel,
+              [&](Trame *trame) {
+                PROFIL_ETAPE("energie");
+                Mat gris;
+                cvtColor(trame->image, gris, COLOR_BGR2GRAY);
+                if (seam_type == SEAM_ROWS) {
+                  Mat image_t, gris_t;
+                  transpose(trame->image, image_t);
+                  transpose(gris, gris_t);
+                  trame->image = image_t;
+                  gris = gris_t;
+                }
+                trame->energie = filtreEnergie(gris);
+                return trame;
+              }) &
+          tbb::make_filter<Trame *, Trame *>(
+              tbb::filter_mode::serial_in_order,
+              [&](Trame *trame) {
+                if (erreur) {
+                  return trame;
+                }
+                if (NB_TOUR >= trame->image.cols) {
+                  cerr << "Erreur : Nombre de seams invalide (" << NB_TOUR
+                       << ")." << endl;
+                  erreur = true;
+                  return trame;
+                }
+                // Nouvelle taille : les seams précédents ne servent plus
+                if (trame->image.size() != taille) {
+                  if (!allouerWorkspace(ws, trame->image.rows,
+                                        trame->image.cols)) {
+                    erreur = true;
+                    return trame;
+                  }
+                  seams.assign((size_t)NB_TOUR * trame->image.rows, 0);
+                  taille = trame->image.size();
+                  couloir = false;
+                }
+                PROFIL_ETAPE("carving");
+                boucleSeamsColsSequence(trame->image, trame->energie, NB_TOUR,
+                                        ws, seams.data(),
+                                        couloir && options.largeur_couloir > 0,
+                                        options.largeur_couloir);
+                couloir = true;
+                compterSeamsProfil(NB_TOUR);
+                return trame;
+              }) &
+          tbb::make_filter<Trame *, void>(
+              tbb::filter_mode::serial_in_order, [&](Trame *trame) {
+                PROFIL_ETAPE("ecriture");
+                if (!erreur) {
+                  Mat resized_image;
+                  if (seam_type == SEAM_ROWS) {
+                    transpose(trame->image, resized_image);
+                  } else {
+                    resized_image = trame->image;
+                  }
+                  if (est_repertoire) {
+                    imwrite(repertoire + "resized_" + suffixe + trame->nom,
+                            resized_image);
+                  } else {
+                    // Ouvert à la première image, dont on connaît la taille
+                    if (!sortie.isOpened() &&
+                        !sortie.open(fichier_video,
+                                     VideoWriter::fourcc('M', 'J', 'P', 'G'),
+                                     cadence, resized_image.size())) {
+                      cerr << "Erreur d'écriture de la vidéo " << fichier_video
+                           << "." << endl;
+                      erreur = true;
+                    } else {
+                      sortie.write(resized_image);
+                    }
+                  }
+                  ++nb_images;
+                }
+                delete trame;
+              }));
+  libererWorkspace(ws);
+  if (erreur) {
+    return -1;
+  }
+
+  double duree =
+      chrono::duration<double>(chrono::steady_clock::now() - debut).count();
+  cout << nb_images << " images réduites en " << duree << " s ("
+       << nb_images / duree << " images/s)" << endl;
+  if (est_repertoire) {
+    cout << "Images resized enregistrées: " << repertoire << "resized_"
+         << suffixe << "*" << endl;
+  } else {
+    cout << "Vidéo resized enregistrée: " << fichier_video << endl;
+  }
+
+  return nb_images;
+} // Fin seamCarvingVideo
@@ -0,0 +1,26 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "seamcarving.h"
+
+/**
+ * Seam carving d'une séquence d'images : fichier vidéo lu par OpenCV ou
+ * répertoire d'images numérotées.
+ *
+ * Lecture, calcul de l'énergie, carving et écriture s'enchaînent dans un
+ * pipeline TBB : plusieurs images sont en vol à la fois. Le carving se fait
+ * dans l'ordre des images, car chacune reprend les seams de la précédente
+ * (voir boucleSeamsColsSequence).
+ */
+
+int seamCarvingVideo(const std::string &source, int NB_TOUR, int seam_type,
+                     const std::string &repertoire,
+                     const SeamOptions &options = SeamOptions());
+
+std::vector<std::filesystem::path> listerImages(const std::string &repertoire);
+
+#endif